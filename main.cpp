@@ -1,10 +1,1027 @@
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <iterator>
+#include <stdexcept>
+#include <initializer_list>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
 #include <iostream>
 #include <vector.hpp>
 #include <angle.hpp>
+#include <matrix.hpp>
+#include <angle_range.hpp>
+#include <kernels.hpp>
+#include <fixed.hpp>
+#include <memory.hpp>
+#include <dynamic_matrix.hpp>
+#include <circular.hpp>
+#include <spherical.hpp>
+#include <random.hpp>
+#include <direction_index.hpp>
+#include <frustum.hpp>
+#include <intersection.hpp>
 
+namespace {
 
-int main(int, char**) {
+	int failures = 0;
+
+	void check(bool condition, char const* expression, int line) {
+		if (!condition) {
+			++failures;
+			std::cerr << "main.cpp:" << line << ": check failed: " << expression << std::endl;
+		}
+	}
+
+	#define CHECK(...) check((__VA_ARGS__), #__VA_ARGS__, __LINE__)
+
+	////////////////////////////////////////////////////////////////////////////////
+	// kernels.
+
+	/// largest absolute error of fast_sincos against the C library over
+	/// [-range, range], and of fast_atan2 round a circle of radius 3.
+	template <typename _T>
+	void kernel_errors(double range, double& sincos_error, double& atan2_error) {
+		sincos_error = atan2_error = 0;
+		for (int i = -100000; i <= 100000; ++i) {
+			_T const x = static_cast<_T>(range * i / 100000.0);
+			_T s, c;
+			math::internal::fast_sincos(x, s, c);
+			sincos_error = std::fmax(sincos_error, std::fabs(s - std::sin(static_cast<double>(x))));
+			sincos_error = std::fmax(sincos_error, std::fabs(c - std::cos(static_cast<double>(x))));
+		}
+		for (int i = 0; i <= 100000; ++i) {
+			double const a = 6.283185307179586 * i / 100000.0;
+			_T const y = static_cast<_T>(3 * std::sin(a)), x = static_cast<_T>(3 * std::cos(a));
+			double const expected = std::atan2(static_cast<double>(y), static_cast<double>(x));
+			atan2_error = std::fmax(atan2_error, std::fabs(math::internal::fast_atan2(y, x) - expected));
+		}
+	}
+
+	template <typename _T>
+	bool sincos_is_nan(_T x) {
+		_T s, c;
+		math::internal::fast_sincos(x, s, c);
+		return std::isnan(s) && std::isnan(c);
+	}
+
+	void test_kernels() {
+		double sincos_error, atan2_error;
+
+		kernel_errors<float>(6283.0, sincos_error, atan2_error);
+		CHECK(sincos_error < 2e-7);
+		CHECK(atan2_error < 5e-7);
+
+		kernel_errors<double>(6283.0, sincos_error, atan2_error);
+		CHECK(sincos_error < 1e-15);
+		CHECK(atan2_error < 1e-15);
+
+		CHECK(sincos_is_nan(std::numeric_limits<float>::quiet_NaN()));
+		CHECK(sincos_is_nan(std::numeric_limits<float>::infinity()));
+		CHECK(sincos_is_nan(-std::numeric_limits<double>::infinity()));
+
+		// out of range: unspecified values, but no undefined conversion.
+		float s, c;
+		math::internal::fast_sincos(1e30f, s, c);
+
+		CHECK(math::internal::fast_atan2(0.0f, 0.0f) == 0.0f);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	// vectors.
+
+	void test_vectors() {
+		math::radians<double> const half_pi { 1.5707963267948966 };
+		math::vector3<double> const v(half_pi, half_pi, 2.0);
+		CHECK(std::fabs(v.x) < 1e-15 && std::fabs(v.y - 2.0) < 1e-15 && std::fabs(v.z) < 1e-15);
+
+		math::vector3<float> const w { 1.0f, 2.0f, 3.0f };
+		CHECK(w.x == 1.0f && w.y == 2.0f && w.z == 3.0f);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	// matrices.
+
+	// default construction leaves elements uninitialized, so buffers of
+	// vectors and matrices are not zero-filled.
+	static_assert(std::is_trivially_default_constructible<math::vector3<float>>::value, "vector3 must be trivial");
+	static_assert(std::is_trivially_default_constructible<math::matrix4x4<float>>::value, "matrix4x4 must be trivial");
+
+	constexpr math::matrix4x4<double> quarter_turn() {
+		math::matrix4x4<double> m = math::matrix4x4<double>::identity();
+		m.zrotation(math::radians<double> { 1.5707963267948966 });
+		m.translation(1.0, 2.0, 3.0);
+		return m;
+	}
+
+	constexpr math::matrix4x4<double> folded = quarter_turn();
+	static_assert(folded(1, 0) > 0.999999 && folded(0, 1) < -0.999999 && folded(2, 3) == 3.0, "rotation must fold");
+
+	void test_matrices() {
+		math::radians<float> const angle { 0.7f };
+		math::matrix3x3<float> m = math::matrix3x3<float>::identity();
+		m.rotation(angle);
+		CHECK(m(0, 0) == std::cos(0.7f) && m(1, 0) == std::sin(0.7f));
+
+		math::matrix3x3<float> zero {};
+		CHECK(zero(2, 2) == 0.0f && (zero * m)(1, 1) == 0.0f);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	// angle ranges.
+
+	void test_angle_range() {
+		auto const range = math::angle_range(math::degrees<float>(0.0f), math::degrees<float>(360.0f), math::degrees<float>(0.5f));
+		CHECK(range.size() == 720);
+
+		auto const directions = range.directions();
+		std::vector<math::vector2<float>> const forward(directions.begin(), directions.end());
+		CHECK(forward.size() == 720);
+
+		double error = 0;
+		for (std::size_t i = 0; i < forward.size(); ++i) {
+			double const a = i * 0.5 * 3.141592653589793 / 180.0;
+			error = std::fmax(error, std::fabs(forward[i].x - std::cos(a)) + std::fabs(forward[i].y - std::sin(a)));
+		}
+		CHECK(error < 1e-5);
+
+		// a chunk starting mid-range reproduces the single pass exactly.
+		auto const chunk = range.chunk(2, 3).directions();
+		std::size_t i = 480;
+		bool same = true;
+		for (auto it = chunk.begin(); it != chunk.end(); ++it, ++i) same = same && *it == forward[i];
+		CHECK(same && i == 720);
+
+		// stepping backwards stays within the recurrence error.
+		error = 0;
+		auto it = directions.end();
+		for (std::size_t j = forward.size(); j-- > 0; ) {
+			--it;
+			error = std::fmax(error, std::fabs((*it).x - forward[j].x) + std::fabs((*it).y - forward[j].y));
+		}
+		CHECK(error < 1e-5);
+		CHECK(it == directions.begin());
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	// fixed point.
+
+	typedef math::fixed16_16 fixed;
+
+	// integers out of range wrap, also in constant expressions.
+	static_assert(fixed(3).raw() == 3 << 16 && fixed(-3).raw() == -(3 << 16), "integral construction");
+	static_assert(fixed(40000).raw() == static_cast<std::int32_t>(40000u << 16), "integral construction wraps");
+
+	// quotients round to nearest, ties away from zero, whatever the signs.
+	static_assert((fixed(2) / fixed(3)).raw() == 43691 && (fixed(-2) / fixed(3)).raw() == -43691, "division rounds");
+	static_assert((fixed::from_raw(3) / fixed(2)).raw() == 2 && (fixed::from_raw(3) / fixed(-2)).raw() == -2, "division ties");
+	static_assert((fixed::from_raw(-3) / fixed(-2)).raw() == 2 && (fixed::from_raw(1) / fixed(3)).raw() == 0, "division signs");
+
+	void test_fixed() {
+		std::int32_t const max = std::numeric_limits<std::int32_t>::max();
+		std::int32_t const min = std::numeric_limits<std::int32_t>::min();
+		CHECK(fixed::from_raw(max) + fixed::from_raw(1) == fixed::from_raw(min));
+		CHECK(fixed::from_raw(min) - fixed::from_raw(1) == fixed::from_raw(max));
+		CHECK(-fixed::from_raw(min) == fixed::from_raw(min));
+
+		CHECK(fixed(1.5) * fixed(-2) == fixed(-3));
+		CHECK(fixed(0.25f) == fixed::from_raw(1 << 14) && fixed(-0.25) == fixed::from_raw(-(1 << 14)));
+		CHECK(static_cast<double>(fixed(7) / fixed(2)) == 3.5);
+		CHECK(sqrt(fixed(9)) == fixed(3));
+
+		// the batch kernel gives the same bits as the scalar dot product.
+		std::vector<math::vector3<fixed>> a, b;
+		for (int i = 0; i < 37; ++i) {
+			a.push_back(math::vector3<fixed>(fixed(i * 0.37), fixed(-i * 1.1), fixed(0.5)));
+			b.push_back(math::vector3<fixed>(fixed(1.25), fixed(i * 0.03), fixed(-i)));
+		}
+		std::vector<fixed> out(a.size());
+		math::dot_products(a.data(), b.data(), a.size(), out.data());
+		bool same = true;
+		for (std::size_t i = 0; i < a.size(); ++i) same = same && out[i] == dot_product(a[i], b[i]);
+		CHECK(same);
+
+		// sums past the wide type wrap like the scalar operators.
+		fixed const big(30000);
+		math::vector3<fixed> const large(big, big, big);
+		fixed large_dot;
+		math::dot_products(&large, &large, 1, &large_dot);
+		CHECK(large_dot == big * big + big * big + big * big && dot_product(large, large) == large_dot);
+
+		// m maps (x, y, z) to (-y + 1, x + 2, z - 3); the last row is left
+		// out, so it does not matter.
+		math::matrix4x4<fixed> m = math::matrix4x4<fixed>::identity();
+		m(0, 0) = m(1, 1) = fixed(0);
+		m(0, 1) = fixed(-1); m(1, 0) = fixed(1);
+		m(0, 3) = fixed(1); m(1, 3) = fixed(2); m(2, 3) = fixed(-3);
+		std::vector<math::vector3<fixed>> moved(a.size());
+		math::transform_points(m, a.data(), a.size(), moved.data());
+		same = true;
+		for (std::size_t i = 0; i < a.size(); ++i)
+			same = same && moved[i].x == fixed(1) - a[i].y && moved[i].y == a[i].x + fixed(2) && moved[i].z == a[i].z - fixed(3);
+		CHECK(same);
+	}
+
+	// floating point values out of range saturate; nan becomes zero.
+	static_assert(fixed(1e10).raw() == std::numeric_limits<std::int32_t>::max(), "floating construction saturates");
+	static_assert(fixed(-1e10f).raw() == std::numeric_limits<std::int32_t>::min(), "floating construction saturates");
+	static_assert(fixed(32767.99999).raw() == std::numeric_limits<std::int32_t>::max(), "floating construction rounds");
+	static_assert(fixed(std::numeric_limits<double>::quiet_NaN()).raw() == 0, "nan becomes zero");
+
+	void test_fixed_rotation() {
+		double const angle = 0.5;
+		math::radians<fixed> const radians { fixed(angle) };
+
+		math::matrix3x3<fixed> m = math::matrix3x3<fixed>::identity();
+		m.rotation(radians);
+		CHECK(std::fabs(static_cast<double>(m(0, 0)) - std::cos(angle)) < 1e-4 && std::fabs(static_cast<double>(m(1, 0)) - std::sin(angle)) < 1e-4);
+		CHECK(m(0, 1) == -m(1, 0) && m(1, 1) == m(0, 0) && m(2, 2) == fixed(1));
+
+		math::matrix4x4<fixed> n = math::matrix4x4<fixed>::identity();
+		n.xrotation(radians);
+		CHECK(n(1, 1) == m(0, 0) && n(2, 1) == m(1, 0) && n(0, 0) == fixed(1));
+		n.yrotation(radians);
+		CHECK(n(2, 2) == m(0, 0) && n(0, 2) == m(1, 0));
+		n.zrotation(radians);
+		n.zrotate(radians);
+		double const c2 = std::cos(2 * angle);
+		CHECK(std::fabs(static_cast<double>(n(0, 0)) - c2) < 1e-4 && n(3, 3) == fixed(1));
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	// memory.
+
+	static_assert(sizeof(math::padded_vector3<float>) == 16 && alignof(math::padded_vector3<float>) == 16, "padded float layout");
+	static_assert(sizeof(math::padded_vector3<double>) == 32 && alignof(math::padded_vector3<double>) == 32, "padded double layout");
+
+	bool aligned(void const* ptr, std::size_t alignment) {
+		return reinterpret_cast<std::uintptr_t>(ptr) % alignment == 0;
+	}
+
+	void test_memory() {
+		// over-aligned elements get their alignment from every supported
+		// allocation path, not only from new under c++17.
+		typedef math::padded_vector3<double> padded;
+		bool ok = true;
+		for (std::size_t n = 1; n < 9; ++n) {
+			math::aligned_vector<padded> buffer(n);
+			padded* single = new padded(math::vector3<double>(1.0, 2.0, 3.0));
+			padded* array = new padded[n];
+			ok = ok && aligned(buffer.data(), 32) && aligned(single, 32) && aligned(array, 32) && single->z == 3.0;
+			delete single;
+			delete[] array;
+		}
+		CHECK(ok);
+
+		// placement new is not hidden by the class allocation functions.
+		typedef math::padded_vector3<float> padded_float;
+		alignas(padded_float) unsigned char storage[sizeof(padded_float)];
+		padded_float* placed = new (storage) padded_float(1.f, 2.f, 3.f);
+		CHECK(static_cast<void*>(placed) == storage && placed->y == 2.f);
+		placed->~padded_float();
+
+		math::frame_arena arena(256);
+		math::arena_vector<padded> temporaries { math::arena_allocator<padded>(arena) };
+		for (int i = 0; i < 20; ++i) temporaries.push_back(math::vector3<double>(i, i, i));
+		CHECK(aligned(temporaries.data(), 32) && temporaries[19].y == 19.0);
+
+		// once the first frame has grown the arena, later frames of the same
+		// shape reuse its blocks: rewinding to a mark or resetting gives back
+		// the same addresses and the capacity stays put.
+		math::frame_arena frames(256);
+		std::size_t first_capacity = 0;
+		void* first_start = nullptr;
+		bool steady = true;
+		for (int frame = 0; frame < 4; ++frame) {
+			void* const start = frames.allocate(64);
+			math::frame_arena::marker const m = frames.mark();
+			for (int i = 0; i < 10; ++i) frames.allocate<double>(40);
+			frames.rewind(m);
+			steady = steady && frames.allocate(64) == static_cast<char*>(start) + 64;
+			{
+				math::frame_arena::scope const nested(frames);
+				frames.allocate(1000);
+			}
+			steady = steady && frames.mark().block == m.block && frames.mark().offset == m.offset + 64;
+			if (frame == 0) {
+				first_capacity = frames.capacity();
+				first_start = start;
+			}
+			else steady = steady && frames.capacity() == first_capacity && start == first_start;
+			frames.reset();
+		}
+		CHECK(steady && first_capacity > 256);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	// dynamic matrices.
+
+	/// rows x columns matrix of small integers, so every product below is exact.
+	template <typename _T, typename _Order>
+	math::dynamic_matrix<_T, _Order> integer_matrix(std::size_t rows, std::size_t columns, unsigned seed) {
+		math::dynamic_matrix<_T, _Order> result(columns, rows);
+		for (std::size_t r = 0; r < rows; ++r)
+			for (std::size_t c = 0; c < columns; ++c)
+				result(r, c) = static_cast<_T>(static_cast<int>((r * 7 + c * 13 + seed) % 17) - 8);
+		return result;
+	}
+
+	template <typename _T, typename _O1, typename _O2>
+	bool multiply_matches(std::size_t m, std::size_t n, std::size_t k, unsigned threads) {
+		auto const a = integer_matrix<_T, _O1>(m, k, 1);
+		auto const b = integer_matrix<_T, _O2>(k, n, 2);
+		auto const c = math::multiply(a, b, threads);
+		if (c.rows() != m || c.columns() != n) return false;
+
+		for (std::size_t r = 0; r < m; ++r)
+			for (std::size_t j = 0; j < n; ++j) {
+				_T expected = 0;
+				for (std::size_t p = 0; p < k; ++p) expected += a(r, p) * b(p, j);
+				if (c(r, j) != expected) return false;
+			}
+		return true;
+	}
+
+	void test_dynamic_matrix() {
+		typedef math::column_major cm;
+		typedef math::row_major rm;
+
+		// sizes that are not multiples of the register tile or of the packing
+		// blocks (k > kc = 256, m > mc = 128), with either storage order.
+		std::size_t const sizes[][3] = { { 1, 1, 1 }, { 7, 13, 5 }, { 37, 19, 300 }, { 130, 9, 3 }, { 3, 130, 17 } };
+		for (auto const& s : sizes) {
+			CHECK(multiply_matches<float, cm, cm>(s[0], s[1], s[2], 1));
+			CHECK(multiply_matches<double, cm, cm>(s[0], s[1], s[2], 1));
+			CHECK(multiply_matches<double, rm, cm>(s[0], s[1], s[2], 1));
+			CHECK(multiply_matches<float, cm, rm>(s[0], s[1], s[2], 1));
+			CHECK(multiply_matches<double, rm, rm>(s[0], s[1], s[2], 1));
+			CHECK(multiply_matches<int, rm, cm>(s[0], s[1], s[2], 1));
+		}
+
+		// large enough to be split across workers.
+		CHECK(multiply_matches<double, cm, cm>(70, 75, 71, 3));
+		CHECK(multiply_matches<float, rm, cm>(67, 70, 80, 4));
+
+		math::dynamic_matrix<double> const i = math::dynamic_matrix<double>::identity(5);
+		CHECK(i * i == i);
+
+		// much smaller than the packing blocks, asking for more threads than
+		// the product uses.
+		CHECK(multiply_matches<double, cm, cm>(2, 3, 1, 64));
+	}
+
+	template <typename _Matrix>
+	void set_rows(_Matrix& m, std::initializer_list<std::initializer_list<double>> rows) {
+		std::size_t r = 0;
+		for (auto const& row : rows) {
+			std::size_t c = 0;
+			for (double value : row) m(r, c++) = value;
+			++r;
+		}
+	}
+
+	template <typename _Matrix1, typename _Matrix2>
+	double max_difference(_Matrix1 const& a, _Matrix2 const& b, std::size_t n) {
+		double result = 0;
+		for (std::size_t r = 0; r < n; ++r)
+			for (std::size_t c = 0; c < n; ++c) result = std::fmax(result, std::fabs(a(r, c) - b(r, c)));
+		return result;
+	}
+
+	void test_dynamic_matrix_algebra() {
+		// the second difference matrix: determinant 4, inverse with entries
+		// min(r, c) * (4 - max(r, c)) / 4 for r, c in 1 .. 3.
+		math::dynamic_matrix<double> a(3, 3), expected_inverse(3, 3);
+		set_rows(a, { { 2, -1, 0 }, { -1, 2, -1 }, { 0, -1, 2 } });
+		set_rows(expected_inverse, { { 0.75, 0.5, 0.25 }, { 0.5, 1, 0.5 }, { 0.25, 0.5, 0.75 } });
+		CHECK(std::fabs(a.determinant() - 4) < 1e-12);
+		CHECK(max_difference(a.inverse(), expected_inverse, 3) < 1e-12);
+		CHECK(max_difference(a * a.inverse(), math::dynamic_matrix<double>::identity(3), 3) < 1e-12);
+
+		// a row swap flips the sign; a singular matrix has determinant zero.
+		math::dynamic_matrix<double, math::row_major> b(2, 2), singular(2, 2);
+		set_rows(b, { { 4, 3 }, { 6, 3 } });
+		set_rows(singular, { { 1, 2 }, { 2, 4 } });
+		CHECK(std::fabs(b.determinant() + 6) < 1e-12 && singular.determinant() == 0);
+
+		// doolittle without pivoting: l = [1 0; 1.5 1], u = [4 3; 0 -1.5].
+		auto const lower = b.lower_decompose(), upper = b.upper_decompose();
+		math::dynamic_matrix<double, math::row_major> l(2, 2), u(2, 2);
+		set_rows(l, { { 1, 0 }, { 1.5, 1 } });
+		set_rows(u, { { 4, 3 }, { 0, -1.5 } });
+		CHECK(lower == l && upper == u && lower * upper == b);
+
+		bool threw = false;
+		try { math::dynamic_matrix<double>(2, 3).determinant(); }
+		catch (std::invalid_argument const&) { threw = true; }
+		CHECK(threw);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	// matrix storage, views and algebra.
+
+	void test_matrix_storage() {
+		// 3 columns by 2 rows, element (r, c) = 10 r + c.
+		math::matrix<float, 3, 2, math::row_major> rows {};
+		set_rows(rows, { { 0, 1, 2 }, { 10, 11, 12 } });
+		float const row_layout[] = { 0, 1, 2, 10, 11, 12 };
+		CHECK(std::equal(rows.begin(), rows.end(), row_layout) && rows.data() == &rows(0, 0) && rows.data() + 1 == &rows(0, 1));
+
+		// converting the order keeps the elements and changes the layout.
+		math::matrix<float, 3, 2> const columns = rows;
+		float const column_layout[] = { 0, 10, 1, 11, 2, 12 };
+		CHECK(std::equal(columns.begin(), columns.end(), column_layout));
+		math::matrix<double, 3, 2, math::row_major> const back = columns;
+		CHECK(std::equal(back.begin(), back.end(), row_layout));
+
+		// the transposed view of either order reads the same elements.
+		math::matrix_view<float, 2, 3> const t = rows.transposed();
+		math::matrix_view<float const, 2, 3> const ct = columns.transposed();
+		bool transposed = true;
+		for (std::size_t r = 0; r < 2; ++r)
+			for (std::size_t c = 0; c < 3; ++c)
+				transposed = transposed && t(c, r) == rows(r, c) && ct(c, r) == rows(r, c);
+		math::matrix<float, 2, 3> const copied = t;
+		CHECK(transposed && copied(2, 1) == 12 && copied(0, 1) == 10);
+
+		// writes through a transposed view land in the matrix.
+		t(2, 0) = -2;
+		CHECK(rows(0, 2) == -2);
+
+		// a block of a 4x4, read, written and assigned a matrix.
+		math::matrix4x4<double, math::row_major> m {};
+		for (std::size_t r = 0; r < 4; ++r)
+			for (std::size_t c = 0; c < 4; ++c) m(r, c) = static_cast<double>(4 * r + c);
+		auto const b = m.block<2, 3>(1, 2);
+		CHECK(b(0, 0) == 6 && b(2, 1) == 15 && b.row_stride() == 4 && b.column_stride() == 1);
+		math::matrix<double, 2, 2> patch {};
+		set_rows(patch, { { -1, -2 }, { -3, -4 } });
+		m.block<2, 2>(2, 0) = patch;
+		CHECK(m(2, 0) == -1 && m(2, 1) == -2 && m(3, 0) == -3 && m(3, 1) == -4 && m(1, 0) == 4 && m(3, 2) == 14);
+		CHECK(m.block<2, 2>(0, 0).transposed()(1, 0) == 1);
 
+		// rows and columns assigned through views, from vectors and from
+		// other views.
+		math::matrix3x3<float> n {};
+		n[1] = math::vector3<float>(1, 2, 3);
+		CHECK(n(0, 1) == 1 && n(1, 1) == 2 && n(2, 1) == 3 && n(0, 0) == 0);
+		n.row(0) = n[1];
+		CHECK(n(0, 0) == 1 && n(0, 1) == 2 && n(0, 2) == 3);
+		n.view().row(2) = n.row(0);
+		CHECK(n(2, 0) == 1 && n(2, 1) == 2 && n(2, 2) == 3);
+		n[2] += math::vector3<float>(1, 1, 1);
+		n.row(1) *= 2;
+		CHECK(n(0, 2) == 4 && n(1, 2) == 2 && n(2, 2) == 4 && n(1, 1) == 4);
+	}
+
+	void test_matrix_algebra() {
+		// the same second difference matrix as the dynamic test, in both
+		// orders and both precisions.
+		math::matrix3x3<double> a {}, expected_inverse {};
+		set_rows(a, { { 2, -1, 0 }, { -1, 2, -1 }, { 0, -1, 2 } });
+		set_rows(expected_inverse, { { 0.75, 0.5, 0.25 }, { 0.5, 1, 0.5 }, { 0.25, 0.5, 0.75 } });
+		CHECK(std::fabs(a.determinant() - 4) < 1e-12);
+		CHECK(max_difference(a.inverse(), expected_inverse, 3) < 1e-12);
+
+		math::matrix3x3<float, math::row_major> const f = a;
+		CHECK(std::fabs(f.determinant() - 4) < 1e-5f);
+		CHECK(max_difference(f.inverse(), expected_inverse, 3) < 1e-6);
+
+		// a rotation and translation: determinant 1, and the inverse undoes it.
+		math::matrix4x4<double> const transform = quarter_turn();
+		CHECK(std::fabs(transform.determinant() - 1) < 1e-12);
+		CHECK(max_difference(transform * transform.inverse(), math::matrix4x4<double>::identity(), 4) < 1e-12);
+		CHECK(std::fabs(transform.inverse()(0, 3) + 2) < 1e-12 && std::fabs(transform.inverse()(1, 3) - 1) < 1e-12);
+
+		// a row swap flips the sign; a singular matrix has determinant zero
+		// and a non-finite inverse.
+		math::matrix2x2<double> b {}, singular {};
+		set_rows(b, { { 4, 3 }, { 6, 3 } });
+		set_rows(singular, { { 1, 2 }, { 2, 4 } });
+		CHECK(std::fabs(b.determinant() + 6) < 1e-12 && singular.determinant() == 0);
+		CHECK(!std::isfinite(singular.inverse()(0, 0)));
+
+		// doolittle without pivoting, as in the dynamic test.
+		math::matrix2x2<double> l {}, u {};
+		set_rows(l, { { 1, 0 }, { 1.5, 1 } });
+		set_rows(u, { { 4, 3 }, { 0, -1.5 } });
+		CHECK(max_difference(b.lower_decompose(), l, 2) == 0 && max_difference(b.upper_decompose(), u, 2) == 0);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	// circular statistics.
+
+	/// largest standard deviation, in radians, of 100 equal samples at any of
+	/// the test angles, added in batches and one by one; false if any resultant
+	/// length leaves [0, 1] or any deviation is not finite.
+	template <typename _T>
+	bool equal_samples_spread(double& spread) {
+		spread = 0;
+		double const angles[] = { 0.0, 0.3, 1.0, 2.5, 4.0, -3.0, 37.0 * 3.141592653589793 / 180.0 };
+		for (double a : angles) {
+			std::vector<math::radians<_T>> const samples(100, math::radians<_T>(static_cast<_T>(a)));
+			std::vector<_T> const weights(100, _T(0.5));
+			math::circular_accumulator<_T> batch(samples.begin(), samples.end()), weighted, single;
+			weighted.add(samples.begin(), samples.end(), weights.begin());
+			for (auto const& x : samples) single.add(x);
+
+			for (auto const* acc : { &batch, &weighted, &single }) {
+				double const r = acc->resultant_length();
+				double const sd = math::radians<double>(acc->standard_deviation()).value();
+				if (!(r >= 0 && r <= 1 && acc->variance() >= 0 && std::isfinite(sd) && sd >= 0)) return false;
+				spread = std::fmax(spread, sd);
+			}
+		}
+		return true;
+	}
+
+	void test_circular() {
+		double spread;
+		CHECK(equal_samples_spread<float>(spread) && spread < 5e-4);
+		CHECK(equal_samples_spread<double>(spread) && spread < 1e-7);
+
+		// opposite samples cancel.
+		math::circular_accumulator<double> acc;
+		acc.add(math::degrees<double>(10.0));
+		acc.add(math::degrees<double>(190.0));
+		CHECK(acc.resultant_length() < 1e-15 && acc.variance() <= 1);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	// direction index.
+
+	/// pseudo-random vectors in [-1, 1)^3 of varying length.
+	template <typename _T>
+	std::vector<math::vector3<_T>> scattered_vectors(std::size_t count, unsigned seed) {
+		std::vector<math::vector3<_T>> result;
+		std::uint32_t state = seed * 2654435761u + 1;
+		auto const next = [&state]() {
+			state = state * 1664525u + 1013904223u;
+			return static_cast<_T>(state >> 8) / _T(8388608) - _T(1);
+		};
+		for (std::size_t i = 0; i < count; ++i) {
+			_T const x = next(), y = next(), z = next();
+			result.push_back(math::vector3<_T>(x, y, z));
+		}
+		return result;
+	}
+
+	/// true if matches are the k best of directions for query, best first,
+	/// compared with an exhaustive search in double precision.
+	template <typename _T, typename _Match>
+	bool is_top_k(std::vector<math::vector3<_T>> const& directions, math::vector3<_T> const& query, std::size_t k, std::vector<_Match> const& matches) {
+		auto const cosine = [&](std::size_t i) {
+			math::vector3<double> const d(directions[i].x, directions[i].y, directions[i].z), q(query.x, query.y, query.z);
+			return dot_product(d, q) / (d.length() * q.length());
+		};
+		std::vector<double> all;
+		for (std::size_t i = 0; i < directions.size(); ++i) all.push_back(cosine(i));
+		std::sort(all.begin(), all.end(), [](double a, double b) { return a > b; });
+
+		double const tolerance = std::is_same<_T, float>::value ? 1e-5 : 1e-12;
+		if (matches.size() != std::min(k, directions.size())) return false;
+		for (std::size_t i = 0; i < matches.size(); ++i) {
+			if (std::fabs(matches[i].similarity - all[i]) > tolerance) return false;
+			if (std::fabs(cosine(matches[i].index) - all[i]) > tolerance) return false;
+		}
+		return true;
+	}
+
+	template <typename _T>
+	void test_direction_index(std::size_t resolution) {
+		auto const directions = scattered_vectors<_T>(1000, 1);
+		auto const queries = scattered_vectors<_T>(50, 2);
+		math::direction_index<_T> const index(directions.begin(), directions.end(), resolution);
+		CHECK(index.size() == directions.size() && index.resolution() == resolution);
+
+		bool ok = true;
+		std::size_t const ks[] = { 1, 5, 70 };
+		for (std::size_t k : ks)
+			for (auto const& q : queries) ok = ok && is_top_k(directions, q, k, index.nearest(q, k));
+		CHECK(ok);
+
+		// k beyond the size returns everything, ranked; k = 0 returns nothing.
+		std::vector<math::vector3<_T>> const few(directions.begin(), directions.begin() + 7);
+		math::direction_index<_T> const small(few.begin(), few.end(), resolution);
+		CHECK(is_top_k(few, queries[0], 20, small.nearest(queries[0], 20)));
+		CHECK(small.nearest(queries[0], 0).empty());
+
+		// the threaded batch gives the same matches as one query at a time.
+		auto const batch = index.nearest(queries.begin(), queries.end(), 10, 4);
+		bool same = batch.size() == queries.size();
+		for (std::size_t i = 0; same && i < queries.size(); ++i) {
+			auto const single = index.nearest(queries[i], 10);
+			same = batch[i].size() == single.size();
+			for (std::size_t j = 0; same && j < single.size(); ++j)
+				same = batch[i][j].index == single[j].index && batch[i][j].similarity == single[j].similarity;
+		}
+		CHECK(same);
+	}
+
+	void test_direction_index() {
+		test_direction_index<float>(0);
+		test_direction_index<float>(1);
+		test_direction_index<float>(8);
+		test_direction_index<double>(0);
+		test_direction_index<double>(1);
+		test_direction_index<double>(8);
+
+		math::direction_index<float> const empty;
+		CHECK(empty.empty() && empty.nearest(math::vector3<float>(1.0f, 0.0f, 0.0f), 3).empty());
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	// spherical coordinates.
+
+	/// converts count scattered points to spherical coordinates, with theta in
+	/// _Theta units and phi in _Phi units, and back; true if the angles are in
+	/// range and both round trips (with and without the radius) come back
+	/// within tolerance.
+	template <typename _T, typename _Theta, typename _Phi>
+	bool spherical_round_trip(std::size_t count, _T tolerance) {
+		auto const points = scattered_vectors<_T>(count, 3);
+		std::vector<_Theta> theta(count);
+		std::vector<_Phi> phi(count);
+		std::vector<_T> radius(count);
+		math::cartesian_to_spherical(points.begin(), points.end(), theta.begin(), phi.begin(), radius.begin());
+
+		std::vector<math::vector3<_T>> back(count), unit(count);
+		math::spherical_to_cartesian(theta.begin(), theta.end(), phi.begin(), radius.begin(), back.begin());
+		math::spherical_to_cartesian(theta.begin(), theta.end(), phi.begin(), unit.begin());
+
+		_T const pi = _T(3.14159265358979323846);
+		for (std::size_t i = 0; i < count; ++i) {
+			_T const t = math::radians<_T>(theta[i]).value(), p = math::radians<_T>(phi[i]).value();
+			if (!(t >= 0 && t <= pi && p >= -pi && p <= pi)) return false;
+			if (std::fabs(radius[i] - points[i].length()) > tolerance) return false;
+			for (std::size_t j = 0; j < 3; ++j) {
+				if (std::fabs(back[i][j] - points[i][j]) > tolerance) return false;
+				if (std::fabs(unit[i][j] - points[i][j] / radius[i]) > tolerance) return false;
+			}
+		}
+		return true;
+	}
+
+	void test_spherical() {
+		// 150 points: two full blocks of 64 and a partial one.
+		CHECK(spherical_round_trip<float, math::radians<float>, math::radians<float>>(150, 2e-6f));
+		CHECK(spherical_round_trip<float, math::degrees<float>, math::degrees<float>>(150, 2e-6f));
+		CHECK(spherical_round_trip<double, math::radians<double>, math::degrees<double>>(150, 1e-14));
+		CHECK(spherical_round_trip<double, math::degrees<double>, math::radians<double>>(1, 1e-14));
+
+		// the poles and the axes.
+		math::vector3<double> const axes[] = { { 0.0, 0.0, 2.0 }, { 0.0, 0.0, -1.0 }, { 3.0, 0.0, 0.0 }, { 0.0, -1.0, 0.0 } };
+		math::degrees<double> theta[4], phi[4];
+		double radius[4];
+		math::cartesian_to_spherical(std::begin(axes), std::end(axes), theta, phi, radius);
+		CHECK(theta[0].value() == 0.0 && radius[0] == 2.0);
+		CHECK(std::fabs(theta[1].value() - 180.0) < 1e-13 && radius[1] == 1.0);
+		CHECK(std::fabs(theta[2].value() - 90.0) < 1e-13 && phi[2].value() == 0.0 && radius[2] == 3.0);
+		CHECK(std::fabs(theta[3].value() - 90.0) < 1e-13 && std::fabs(phi[3].value() + 90.0) < 1e-13);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	// frustum culling.
+
+	/// perspective projection with a 90 degree field of view, square aspect,
+	/// near plane 1 and far plane 10, looking down -z.
+	math::matrix4x4<double> perspective(math::clip_depth depth) {
+		math::matrix4x4<double> m {};
+		m(0, 0) = m(1, 1) = 1;
+		m(3, 2) = -1;
+		if (depth == math::clip_depth::negative_one_to_one) {
+			m(2, 2) = -11.0 / 9.0;
+			m(2, 3) = -20.0 / 9.0;
+		}
+		else {
+			m(2, 2) = -10.0 / 9.0;
+			m(2, 3) = -10.0 / 9.0;
+		}
+		return m;
+	}
+
+	bool plane_is(math::plane<double> const& p, double x, double y, double z, double w) {
+		math::vector4<double> const c = p.coefficients();
+		return std::fabs(c.x - x) < 1e-12 && std::fabs(c.y - y) < 1e-12 && std::fabs(c.z - z) < 1e-12 && std::fabs(c.w - w) < 1e-12;
+	}
+
+	void test_frustum_planes(math::clip_depth depth) {
+		typedef math::frustum<double> frustum_t;
+		frustum_t const f(perspective(depth), depth);
+		double const h = std::sqrt(0.5);
+		CHECK(plane_is(f[frustum_t::left_plane], h, 0, -h, 0));
+		CHECK(plane_is(f[frustum_t::right_plane], -h, 0, -h, 0));
+		CHECK(plane_is(f[frustum_t::bottom_plane], 0, h, -h, 0));
+		CHECK(plane_is(f[frustum_t::top_plane], 0, -h, -h, 0));
+		CHECK(plane_is(f[frustum_t::near_plane], 0, 0, -1, -1));
+		CHECK(plane_is(f[frustum_t::far_plane], 0, 0, 1, 10));
+
+		CHECK(f.contains(math::vector3<double>(0.0, 0.0, -5.0)) && !f.contains(math::vector3<double>(0.0, 0.0, -0.5)));
+		CHECK(f.intersects_sphere(math::vector3<double>(0.0, 0.0, -10.5), 1.0) && !f.intersects_sphere(math::vector3<double>(0.0, 0.0, -11.5), 1.0));
+	}
+
+	/// batch culling against the single tests for count volumes; count need not
+	/// be a multiple of the 64-volume block.
+	void test_cull(std::size_t count) {
+		math::frustum<float> const f(perspective(math::clip_depth::zero_to_one), math::clip_depth::zero_to_one);
+		auto const centers = scattered_vectors<float>(count, 3), sizes = scattered_vectors<float>(count, 4);
+
+		std::vector<float> x, y, z, ex, ey, ez;
+		for (std::size_t i = 0; i < count; ++i) {
+			x.push_back(centers[i].x * 12); y.push_back(centers[i].y * 12); z.push_back(centers[i].z * 12 - 6);
+			ex.push_back(std::fabs(sizes[i].x) * 2); ey.push_back(std::fabs(sizes[i].y) * 2); ez.push_back(std::fabs(sizes[i].z) * 2);
+		}
+		math::sphere_batch<float> const spheres { x.data(), y.data(), z.data(), ex.data(), count };
+		math::box_batch<float> const boxes { x.data(), y.data(), z.data(), ex.data(), ey.data(), ez.data(), count };
+
+		std::size_t const words = (count + 63) / 64;
+		std::vector<std::uint64_t> sphere_mask(words + 1, ~0ull), box_mask(words + 1, ~0ull);
+		math::cull(f, spheres, sphere_mask.data());
+		math::cull(f, boxes, box_mask.data());
+		std::vector<std::size_t> sphere_indices, box_indices;
+		math::visible(f, spheres, std::back_inserter(sphere_indices));
+		math::visible(f, boxes, std::back_inserter(box_indices));
+
+		std::vector<std::size_t> expected_spheres, expected_boxes;
+		bool masks = sphere_mask[words] == ~0ull && box_mask[words] == ~0ull;
+		for (std::size_t i = 0; i < words * 64; ++i) {
+			math::vector3<float> const center(i < count ? x[i] : 0.0f, i < count ? y[i] : 0.0f, i < count ? z[i] : 0.0f);
+			bool const sphere = i < count && f.intersects_sphere(center, ex[i]);
+			bool const box = i < count && f.intersects_box(center, math::vector3<float>(ex[i], ey[i], ez[i]));
+			if (sphere) expected_spheres.push_back(i);
+			if (box) expected_boxes.push_back(i);
+			masks = masks && ((sphere_mask[i / 64] >> (i % 64)) & 1) == sphere && ((box_mask[i / 64] >> (i % 64)) & 1) == box;
+		}
+		CHECK(masks);
+		CHECK(sphere_indices == expected_spheres && box_indices == expected_boxes);
+		CHECK(count < 100 || (!expected_spheres.empty() && expected_spheres.size() < count));
+	}
+
+	void test_frustum() {
+		test_frustum_planes(math::clip_depth::negative_one_to_one);
+		test_frustum_planes(math::clip_depth::zero_to_one);
+		test_cull(5);
+		test_cull(128);
+		test_cull(1000);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	// ray intersection.
+
+	typedef math::vector3<float> point;
+
+	/// the square [-size, size]^2 in the plane z = depth, as two triangles.
+	void add_square(std::vector<point>& vertices, float size, float depth) {
+		point const a(-size, -size, depth), b(size, -size, depth), c(size, size, depth), d(-size, size, depth);
+		point const quad[] = { a, b, c, a, c, d };
+		vertices.insert(vertices.end(), quad, quad + 6);
+	}
+
+	void test_intersection() {
+		// 10 nested squares, farthest first, so the closest hit sits in the
+		// last of the 8-wide blocks and smaller squares are only hit near the
+		// axis.
+		std::vector<point> vertices;
+		for (int i = 0; i < 10; ++i) add_square(vertices, 10.0f - i, 20.0f - i);
+		math::triangle_blocks<float> const triangles(vertices.begin(), vertices.end());
+		CHECK(triangles.size() == 20 && std::distance(triangles.begin(), triangles.end()) == 3);
+
+		point const down(0.0f, 0.0f, 1.0f);
+		math::ray_packet<float, 8> packet;
+		packet.set(0, math::ray<float> { point(0.1f, 0.2f, 0.0f), down });		// every square: closest is z = 11.
+		packet.set(1, math::ray<float> { point(9.5f, 0.0f, 0.0f), down });		// only the largest square.
+		packet.set(2, math::ray<float> { point(20.0f, 0.0f, 0.0f), down });		// misses.
+		packet.set(3, math::ray<float> { point(0.1f, 0.2f, 0.0f), down }, 10.5f);	// clipped before the nearest square.
+		packet.set(4, math::ray<float> { point(0.1f, 0.2f, 30.0f), -down });	// from behind: z = 20.
+		for (auto const& block : triangles) math::intersect(packet, block);
+
+		math::ray_hit<float> const closest = packet.hit(0);
+		CHECK(closest && std::fabs(closest.t - 11.0f) < 1e-5f && closest.triangle / 2 == 9);
+		CHECK(std::fabs(closest.u + closest.v - 0.5f) < 0.5f);
+		CHECK(packet.hit(1) && std::fabs(packet.hit(1).t - 20.0f) < 1e-5f && packet.hit(1).triangle / 2 == 0);
+		CHECK(!packet.hit(2) && packet.hit(2).t == std::numeric_limits<float>::infinity());
+		CHECK(!packet.hit(3) && packet.hit(3).t == 10.5f);
+		CHECK(packet.hit(4) && std::fabs(packet.hit(4).t - 10.0f) < 1e-5f && packet.hit(4).triangle / 2 == 0);
+
+		// lanes left at their default never hit anything (t_max = 0).
+		bool unused = true;
+		for (std::size_t i = 5; i < 8; ++i) unused = unused && !packet.hit(i) && packet.hit(i).t == 0.0f;
+		CHECK(unused);
+
+		// trace gives the same hits, with no clipping distance.
+		std::vector<math::ray<float>> rays;
+		for (std::size_t i = 0; i < 5; ++i) rays.push_back(packet.get(i));
+		auto const hits = math::trace<4>(triangles, rays.begin(), rays.end(), std::numeric_limits<float>::infinity(), 2);
+		CHECK(hits.size() == 5 && hits[0].triangle == closest.triangle && hits[1].triangle == packet.hit(1).triangle && !hits[2] && hits[3].triangle == closest.triangle);
+
+		// slab test: bit i is set when lane i enters the box before t_max.
+		math::ray_packet<float, 4> slab;
+		slab.set(0, math::ray<float> { point(0.0f, 0.0f, 0.0f), down });		// enters at 5.
+		slab.set(1, math::ray<float> { point(3.0f, 0.0f, 0.0f), down });		// passes beside.
+		slab.set(2, math::ray<float> { point(0.0f, 0.0f, 0.0f), down }, 4.0f);	// stops short.
+		slab.set(3, math::ray<float> { point(0.5f, 0.5f, 6.0f), -down });		// starts inside.
+		float entry[4];
+		std::uint32_t const mask = math::intersect(slab, point(-1.0f, -1.0f, 5.0f), point(1.0f, 1.0f, 7.0f), entry);
+		CHECK(mask == 0x9u && entry[0] == 5.0f && entry[3] == 0.0f);
+
+		// a trailing incomplete triangle is ignored.
+		math::triangle_blocks<float> const partial(vertices.begin(), vertices.begin() + 8);
+		std::uint32_t const indices[] = { 0, 1, 2, 3, 4 };
+		math::triangle_blocks<float> const indexed(vertices.begin(), indices, indices + 5);
+		CHECK(partial.size() == 2 && indexed.size() == 1);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	// random numbers.
+
+	bool block_equals(math::counter_rng::block const& b, std::uint32_t w0, std::uint32_t w1, std::uint32_t w2, std::uint32_t w3) {
+		return b.word[0] == w0 && b.word[1] == w1 && b.word[2] == w2 && b.word[3] == w3;
+	}
+
+	/// mean of component j over the samples.
+	template <typename _Vector>
+	double component_mean(std::vector<_Vector> const& samples, std::size_t j) {
+		double sum = 0;
+		for (auto const& v : samples) sum += v[j];
+		return sum / samples.size();
+	}
+
+	/// true if every sample has unit length and every component mean is
+	/// within tolerance of zero.
+	template <typename _T, std::size_t _N>
+	bool unit_and_centred(std::vector<math::vector<_T, _N>> const& samples, double length_tolerance, double mean_tolerance) {
+		for (auto const& v : samples)
+			if (std::fabs(v.length() - 1) > length_tolerance) return false;
+		for (std::size_t j = 0; j < _N; ++j)
+			if (std::fabs(component_mean(samples, j)) > mean_tolerance) return false;
+		return true;
+	}
+
+	/// true if the upper 3x3 block of every sample is orthonormal with
+	/// determinant 1, and the rest of the matrix (if any) is the identity.
+	template <typename _T, std::size_t _N>
+	bool proper_rotations(std::vector<math::matrix<_T, _N, _N, math::column_major>> const& samples, double tolerance) {
+		for (auto const& m : samples) {
+			double const det = m(0, 0) * (m(1, 1) * m(2, 2) - m(1, 2) * m(2, 1))
+				- m(0, 1) * (m(1, 0) * m(2, 2) - m(1, 2) * m(2, 0))
+				+ m(0, 2) * (m(1, 0) * m(2, 1) - m(1, 1) * m(2, 0));
+			if (std::fabs(det - 1) > tolerance) return false;
+			for (std::size_t r = 0; r < 3; ++r)
+				for (std::size_t c = 0; c < 3; ++c) {
+					double dot = 0;
+					for (std::size_t k = 0; k < 3; ++k) dot += double(m(r, k)) * m(c, k);
+					if (std::fabs(dot - (r == c ? 1 : 0)) > tolerance) return false;
+				}
+			for (std::size_t r = 0; r < _N; ++r)
+				for (std::size_t c = 0; c < _N; ++c)
+					if ((r >= 3 || c >= 3) && m(r, c) != (r == c ? 1 : 0)) return false;
+		}
+		return true;
+	}
+
+	/// true if filling count samples in one call gives the same output as
+	/// two threads' worth of slices with rng.at(), and both leave the
+	/// generator at the same position.
+	template <typename _T, typename _Fill>
+	bool split_fill_matches(std::size_t count, std::size_t split, _Fill fill) {
+		math::counter_rng whole(11, 5), sliced(11, 5);
+		whole.seek(100);
+		sliced.seek(100);
+		std::vector<_T> one(count), two(count);
+		fill(whole, one.begin(), one.end());
+
+		math::counter_rng head = sliced.at(sliced.position()), tail = sliced.at(sliced.position() + split);
+		fill(head, two.begin(), two.begin() + split);
+		fill(tail, two.begin() + split, two.end());
+		sliced.discard(count);
+
+		for (std::size_t i = 0; i < count; ++i)
+			for (std::size_t j = 0; j < 3; ++j)
+				if (one[i][j] != two[i][j]) return false;
+		return whole.position() == sliced.position() && tail.position() == whole.position();
+	}
+
+	void test_random_fills() {
+		// 1000 samples: the means have a standard error of about 0.02 (0.06
+		// for angles in radians), well inside the tolerances below.
+		std::size_t const count = 1000;
+		math::counter_rng rng(2024, 1);
+
+		std::vector<math::radians<double>> radians(count);
+		math::fill_uniform_angles(rng, radians.begin(), radians.end());
+		std::vector<math::degrees<float>> degrees(count);
+		math::fill_uniform_angles(rng, degrees.begin(), degrees.end());
+		bool in_range = true;
+		double radian_sum = 0, degree_sum = 0;
+		for (std::size_t i = 0; i < count; ++i) {
+			in_range = in_range && radians[i].value() >= 0 && radians[i].value() < 6.283185307179586;
+			in_range = in_range && degrees[i].value() >= 0 && degrees[i].value() < 360;
+			radian_sum += radians[i].value();
+			degree_sum += degrees[i].value();
+		}
+		CHECK(in_range && rng.position() == 2 * count);
+		CHECK(std::fabs(radian_sum / count - 3.141592653589793) < 0.25);
+		CHECK(std::fabs(degree_sum / count - 180) < 15);
+
+		std::vector<math::vector2<float>> circle(count);
+		math::fill_unit_circle(rng, circle.begin(), circle.end());
+		CHECK(unit_and_centred(circle, 1e-6, 0.1));
+
+		std::vector<math::vector3<double>> sphere(count);
+		math::counter_rng const sphere_start = rng;
+		math::fill_unit_sphere(rng, sphere.begin(), sphere.end());
+		CHECK(unit_and_centred(sphere, 1e-14, 0.1));
+		// uniform on the sphere: each squared component averages 1/3.
+		double z2 = 0;
+		for (auto const& v : sphere) z2 += v.z * v.z;
+		CHECK(std::fabs(z2 / count - 1.0 / 3.0) < 0.05);
+
+		// the soa form draws the same samples from the same position.
+		std::vector<double> x(count), y(count), z(count);
+		math::counter_rng soa = sphere_start;
+		math::fill_unit_sphere(soa, x.data(), y.data(), z.data(), count);
+		bool same = soa.position() == rng.position();
+		for (std::size_t i = 0; i < count; ++i)
+			same = same && x[i] == sphere[i].x && y[i] == sphere[i].y && z[i] == sphere[i].z;
+		CHECK(same);
+
+		std::vector<math::vector4<double>> quaternions(count);
+		math::fill_unit_quaternions(rng, quaternions.begin(), quaternions.end());
+		CHECK(unit_and_centred(quaternions, 1e-14, 0.1));
+
+		std::vector<math::matrix3x3<double>> rotations(count);
+		math::fill_rotations(rng, rotations.begin(), rotations.end());
+		CHECK(proper_rotations(rotations, 1e-13));
+		std::vector<math::matrix4x4<float>> transforms(count);
+		math::fill_rotations(rng, transforms.begin(), transforms.end());
+		CHECK(proper_rotations(transforms, 2e-6));
+
+		// slices filled from rng.at() match one fill, across a block boundary
+		// and not on one.
+		auto const sphere_fill = [](math::counter_rng& r, std::vector<math::vector3<float>>::iterator first, std::vector<math::vector3<float>>::iterator last) {
+			math::fill_unit_sphere(r, first, last);
+		};
+		CHECK(split_fill_matches<math::vector3<float>>(150, 70, sphere_fill));
+		CHECK(split_fill_matches<math::vector3<float>>(150, 64, sphere_fill));
+		CHECK(split_fill_matches<math::vector4<double>>(150, 97, [](math::counter_rng& r, std::vector<math::vector4<double>>::iterator first, std::vector<math::vector4<double>>::iterator last) {
+			math::fill_unit_quaternions(r, first, last);
+		}));
+	}
+
+	void test_random() {
+		// philox4x32-10 known answers from the reference implementation; the
+		// counter is (index, stream) and the key is the seed, low words first.
+		CHECK(block_equals(math::counter_rng(0, 0).generate(0), 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8));
+		CHECK(block_equals(math::counter_rng(~0ull, ~0ull).generate(~0ull), 0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd));
+		CHECK(block_equals(math::counter_rng(0x299f31d0a4093822ull, 0x0370734413198a2eull).generate(0x85a308d3243f6a88ull),
+			0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1));
+
+		// the stream of operator () is the blocks in order, word by word.
+		math::counter_rng rng(7, 3);
+		rng.seek(41);
+		math::counter_rng::block const b = rng.generate(41);
+		bool same = true;
+		for (int w = 0; w < 4; ++w) same = same && rng() == b.word[w];
+		CHECK(same && rng.position() == 42);
+
+		// the lane-parallel batch rounds match generate, across a carry into
+		// the high counter word.
+		std::uint64_t const first = 0xffffffffull - 10;
+		std::uint32_t word[4][math::internal::random_block];
+		math::internal::philox_block(rng, first, word);
+		same = true;
+		for (std::size_t i = 0; i < math::internal::random_block; ++i) {
+			math::counter_rng::block const expected = rng.generate(first + i);
+			for (int w = 0; w < 4; ++w) same = same && word[w][i] == expected.word[w];
+		}
+		CHECK(same);
+	}
+}
+
+int main(int, char**) {
+	test_kernels();
+	test_vectors();
+	test_matrices();
+	test_angle_range();
+	test_fixed();
+	test_fixed_rotation();
+	test_memory();
+	test_dynamic_matrix();
+	test_dynamic_matrix_algebra();
+	test_matrix_storage();
+	test_matrix_algebra();
+	test_circular();
+	test_spherical();
+	test_random();
+	test_random_fills();
+	test_direction_index();
+	test_frustum();
+	test_intersection();
 
+	if (failures != 0) {
+		std::cerr << failures << " check(s) failed" << std::endl;
+		return 1;
+	}
 	return 0;
-}
\ No newline at end of file
+}
@@ -7,6 +7,12 @@
 
 namespace math {
 
+	/// true for types that may be used wherever the library expects a
+	/// built-in arithmetic type. specialised by user scalar types such as
+	/// basic_fixed (fixed.hpp).
+	template <typename _T>
+	struct is_arithmetic : std::is_arithmetic<_T> {};
+
 	template <typename _T>
 	struct radian_traits {
 		static_assert(::std::is_floating_point<_T>::value,
@@ -23,7 +29,7 @@ namespace math {
 
 	template <typename _T>
 	struct degree_traits {
-		static_assert(::std::is_arithmetic<_T>::value,
+		static_assert(::math::is_arithmetic<_T>::value,
 			"degree_traits<_T> requires arithmetic type.");
 		static constexpr _T pi() noexcept {
 			return static_cast<_T>(180);
@@ -32,7 +38,7 @@ namespace math {
 
 	template <typename _T>
 	struct gradian_traits {
-		static_assert(::std::is_arithmetic<_T>::value,
+		static_assert(::math::is_arithmetic<_T>::value,
 			"gradian_traits<_T> requires arithmetic type.");
 		static constexpr _T pi() noexcept {
 			return static_cast<_T>(200);
@@ -107,12 +113,12 @@ namespace math {
 		//////////////////////////////////////////////////////////////////////////////
 		// compound arithmetic operators.
 
-		basic_angle& operator ++() noexcept {
+		constexpr basic_angle& operator ++() noexcept {
 			++_value;
 			return *this;
 		}
 
-		basic_angle& operator --() noexcept {
+		constexpr basic_angle& operator --() noexcept {
 			--_value;
 			return *this;
 		}
@@ -127,22 +133,22 @@ namespace math {
 			return *this;
 		}
 
-		basic_angle& operator += (basic_angle const& other) noexcept {
+		constexpr basic_angle& operator += (basic_angle const& other) noexcept {
 			_value += other._value;
 			return *this;
 		}
 
-		basic_angle& operator -= (basic_angle const& other) noexcept {
+		constexpr basic_angle& operator -= (basic_angle const& other) noexcept {
 			_value -= other._value;
 			return *this;
 		}
 
-		basic_angle& operator *= (value_type val) noexcept {
+		constexpr basic_angle& operator *= (value_type val) noexcept {
 			_value *= val;
 			return *this;
 		}
 
-		basic_angle& operator /= (value_type val) noexcept {
+		constexpr basic_angle& operator /= (value_type val) noexcept {
 			_value /= val;
 			return *this;
 		}
@@ -331,6 +337,100 @@ namespace math {
 }
 
 namespace math {
+
+	namespace internal {
+		// series evaluation for use in constant expressions. the argument is
+		// reduced to [-pi/2, pi/2] before summing, where the series converges
+		// quickly; evaluation is in long double and rounded once on return.
+		constexpr long double static_sin_reduced(long double x) noexcept {
+			long double const pi = radian_traits<long double>::pi();
+			long double const two_pi = pi * 2;
+
+			x -= two_pi * static_cast<long long>(x / two_pi);
+			if (x > pi) x -= two_pi;
+			if (x < -pi) x += two_pi;
+			if (x > pi / 2) x = pi - x;
+			if (x < -pi / 2) x = -pi - x;
+
+			long double term = x, sum = x;
+			for (int n = 1; n < 16; ++n) {
+				term *= -x * x / static_cast<long double>((2 * n) * (2 * n + 1));
+				sum += term;
+			}
+			return sum;
+		}
+	}
+
+	/// sin and cos usable in constant expressions, e.g. for rotation matrices
+	/// built at compile time. prefer math::sin/math::cos at run time.
+	template <typename _T, typename _Traits>
+	constexpr typename std::common_type<_T, float>::type static_sin(basic_angle<_T, _Traits> const& x) noexcept {
+		typedef typename std::common_type<_T, float>::type common_t;
+		return static_cast<common_t>(internal::static_sin_reduced(radians<long double>(x).value()));
+	}
+
+	template <typename _T, typename _Traits>
+	constexpr typename std::common_type<_T, float>::type static_cos(basic_angle<_T, _Traits> const& x) noexcept {
+		typedef typename std::common_type<_T, float>::type common_t;
+		return static_cast<common_t>(internal::static_sin_reduced(
+			radians<long double>(x).value() + radian_traits<long double>::pi() / 2));
+	}
+
+	namespace internal {
+
+		/// true while a constant expression is being evaluated. compilers
+		/// without the builtin always report true, which keeps the compile-time
+		/// series everywhere.
+		constexpr bool constant_evaluation() noexcept {
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_is_constant_evaluated)
+			return __builtin_is_constant_evaluated();
+#else
+			return true;
+#endif
+#elif defined(_MSC_VER) && _MSC_VER >= 1925
+			return __builtin_is_constant_evaluated();
+#else
+			return true;
+#endif
+		}
+
+		/// static_sin/static_cos inside constant expressions, the C library at
+		/// run time; for constexpr code that also runs at run time. other
+		/// scalars (fixed point) use the sin/cos found for their angle by adl.
+		template <typename _T, typename _Traits>
+		constexpr typename std::common_type<_T, float>::type constexpr_sin(basic_angle<_T, _Traits> const& x, std::true_type) noexcept {
+			typedef typename std::common_type<_T, float>::type common_t;
+			return constant_evaluation() ? static_sin(x) : static_cast<common_t>(std::sin(radians<common_t>(x).value()));
+		}
+
+		template <typename _T, typename _Traits>
+		constexpr typename std::common_type<_T, float>::type constexpr_sin(basic_angle<_T, _Traits> const& x, std::false_type) noexcept {
+			return sin(x);
+		}
+
+		template <typename _T, typename _Traits>
+		constexpr typename std::common_type<_T, float>::type constexpr_sin(basic_angle<_T, _Traits> const& x) noexcept {
+			return constexpr_sin(x, std::is_floating_point<typename std::common_type<_T, float>::type>());
+		}
+
+		template <typename _T, typename _Traits>
+		constexpr typename std::common_type<_T, float>::type constexpr_cos(basic_angle<_T, _Traits> const& x, std::true_type) noexcept {
+			typedef typename std::common_type<_T, float>::type common_t;
+			return constant_evaluation() ? static_cos(x) : static_cast<common_t>(std::cos(radians<common_t>(x).value()));
+		}
+
+		template <typename _T, typename _Traits>
+		constexpr typename std::common_type<_T, float>::type constexpr_cos(basic_angle<_T, _Traits> const& x, std::false_type) noexcept {
+			return cos(x);
+		}
+
+		template <typename _T, typename _Traits>
+		constexpr typename std::common_type<_T, float>::type constexpr_cos(basic_angle<_T, _Traits> const& x) noexcept {
+			return constexpr_cos(x, std::is_floating_point<typename std::common_type<_T, float>::type>());
+		}
+	}
+
 	template <typename _T, typename _Traits>
 	inline typename std::common_type<_T, float>::type sin(basic_angle<_T, _Traits> const& x) { return std::sin(math::rad(x).value()); }
 	template <typename _T, typename _Traits>
@@ -339,5 +439,20 @@ namespace math {
 	inline typename std::common_type<_T, float>::type tan(basic_angle<_T, _Traits> const& x) { return std::tan(math::rad(x).value()); }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// precompiled instantiations (see math.cpp).
+
+#define _MATH_ANGLE_INSTANTIATIONS(_Extern, _T) \
+	_Extern template struct basic_angle<_T, radian_traits<_T>>; \
+	_Extern template struct basic_angle<_T, degree_traits<_T>>; \
+	_Extern template struct basic_angle<_T, gradian_traits<_T>>; \
+	_Extern template struct basic_angle<_T, revolution_traits<_T>>;
+
+#if defined(MATH_EXTERN_TEMPLATES)
+namespace math {
+	_MATH_ANGLE_INSTANTIATIONS(extern, float)
+	_MATH_ANGLE_INSTANTIATIONS(extern, double)
+}
+#endif
 
 #endif // _MATH_ANGLE_HPP
\ No newline at end of file
@@ -0,0 +1,354 @@
+#ifndef _MATH_ANGLE_RANGE_HPP
+#define _MATH_ANGLE_RANGE_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
+
+#include "angle.hpp"
+#include "vector.hpp"
+#include "kernels.hpp"
+
+namespace math {
+
+	namespace internal {
+
+		/// iterator over unit directions start + i * step. values are produced
+		/// by rotating the previous direction by step and are re-anchored with
+		/// an exact sincos every recurrence_interval() steps. going forwards,
+		/// the value at a given index does not depend on how it was reached, so
+		/// ranges split across threads produce the same output as a single
+		/// pass; operator -- rotates backwards and may differ from that in the
+		/// last bits until the next anchor.
+		///
+		/// it has the operations of a random access iterator, but yields values
+		/// rather than references, so its category is input iterator. jumps
+		/// (construction, +=, -=) only record the index; the recurrence state
+		/// is rebuilt on the next dereference.
+		template <typename _T, std::size_t _N>
+		struct direction_iterator {
+			static_assert(_N == 2 || _N == 3,
+				"direction_iterator<T, N> requires N = 2 or N = 3.");
+
+			////////////////////////////////////////////////////////////////////////////////
+			// type definitions.
+
+			typedef std::input_iterator_tag iterator_category;
+			typedef vector<_T, _N> value_type;
+			typedef std::ptrdiff_t difference_type;
+			typedef value_type const* pointer;
+			typedef value_type reference;
+
+			////////////////////////////////////////////////////////////////////////////////
+			// constructors.
+
+			direction_iterator() noexcept
+				: _start(0), _step(0), _index(0), _sin(0), _cos(1), _stale(false)
+				, _step_sin(0), _step_cos(1), _polar_sin(1), _polar_cos(0) {}
+
+			direction_iterator(_T start, _T step, std::size_t index, _T polar_sin, _T polar_cos) noexcept
+				: _start(start), _step(step), _index(index), _sin(0), _cos(1), _stale(true)
+				, _polar_sin(polar_sin), _polar_cos(polar_cos) {
+					fast_sincos(step, _step_sin, _step_cos);
+				}
+
+			////////////////////////////////////////////////////////////////////////////////
+			// dereference operators.
+
+			reference operator *() const noexcept {
+				_sync();
+				return _make(std::integral_constant<std::size_t, _N>());
+			}
+
+			reference operator [](difference_type n) const noexcept {
+				return *(*this + n);
+			}
+
+			////////////////////////////////////////////////////////////////////////////////
+			// increment / decrement operators.
+
+			direction_iterator& operator ++() noexcept {
+				if (_stale) {
+					++_index;
+				}
+				else if (++_index % kernel_traits<_T>::recurrence_interval() == 0) {
+					fast_sincos(_angle(_index), _sin, _cos);
+				}
+				else {
+					_rotate(_step_sin);
+				}
+				return *this;
+			}
+
+			direction_iterator& operator --() noexcept {
+				if (_stale) {
+					--_index;
+				}
+				else if (_index-- % kernel_traits<_T>::recurrence_interval() == 0) {
+					fast_sincos(_angle(_index), _sin, _cos);
+				}
+				else {
+					_rotate(-_step_sin);
+				}
+				return *this;
+			}
+
+			direction_iterator operator ++(int) noexcept {
+				direction_iterator tmp(*this); ++*this;
+				return tmp;
+			}
+
+			direction_iterator operator --(int) noexcept {
+				direction_iterator tmp(*this); --*this;
+				return tmp;
+			}
+
+			direction_iterator& operator += (difference_type n) noexcept {
+				_index += n;
+				_stale = true;
+				return *this;
+			}
+
+			direction_iterator& operator -= (difference_type n) noexcept {
+				_index -= n;
+				_stale = true;
+				return *this;
+			}
+
+			friend direction_iterator operator + (direction_iterator it, difference_type n) noexcept { return it += n; }
+			friend direction_iterator operator + (difference_type n, direction_iterator it) noexcept { return it += n; }
+			friend direction_iterator operator - (direction_iterator it, difference_type n) noexcept { return it -= n; }
+
+			friend difference_type operator - (direction_iterator const& lhs, direction_iterator const& rhs) noexcept {
+				return static_cast<difference_type>(lhs._index) - static_cast<difference_type>(rhs._index);
+			}
+
+			////////////////////////////////////////////////////////////////////////////////
+			// comparison operators.
+
+			friend bool operator == (direction_iterator const& lhs, direction_iterator const& rhs) noexcept { return lhs._index == rhs._index; }
+			friend bool operator != (direction_iterator const& lhs, direction_iterator const& rhs) noexcept { return lhs._index != rhs._index; }
+			friend bool operator < (direction_iterator const& lhs, direction_iterator const& rhs) noexcept { return lhs._index < rhs._index; }
+			friend bool operator > (direction_iterator const& lhs, direction_iterator const& rhs) noexcept { return rhs < lhs; }
+			friend bool operator <= (direction_iterator const& lhs, direction_iterator const& rhs) noexcept { return !(rhs < lhs); }
+			friend bool operator >= (direction_iterator const& lhs, direction_iterator const& rhs) noexcept { return !(lhs < rhs); }
+
+		private:
+			_T _start, _step;
+			std::size_t _index;
+			mutable _T _sin, _cos;
+			mutable bool _stale;
+			_T _step_sin, _step_cos;
+			_T _polar_sin, _polar_cos;
+
+			_T _angle(std::size_t index) const noexcept {
+				return _start + static_cast<_T>(index) * _step;
+			}
+
+			/// rotates by step, or by -step when given -sin(step).
+			void _rotate(_T step_sin) const noexcept {
+				_T const c = _cos * _step_cos - _sin * step_sin;
+				_T const s = _sin * _step_cos + _cos * step_sin;
+				_cos = c; _sin = s;
+			}
+
+			/// rebuilds the recurrence from the anchor at or before _index.
+			void _sync() const noexcept {
+				if (!_stale) return;
+				std::size_t const anchor = _index - _index % kernel_traits<_T>::recurrence_interval();
+				fast_sincos(_angle(anchor), _sin, _cos);
+				for (std::size_t i = anchor; i != _index; ++i) _rotate(_step_sin);
+				_stale = false;
+			}
+
+			value_type _make(std::integral_constant<std::size_t, 2>) const noexcept {
+				return value_type { _cos, _sin };
+			}
+
+			value_type _make(std::integral_constant<std::size_t, 3>) const noexcept {
+				return value_type { _polar_sin * _cos, _polar_sin * _sin, _polar_cos };
+			}
+		};
+
+		template <typename _T, std::size_t _N>
+		struct direction_range {
+			typedef direction_iterator<_T, _N> iterator;
+			typedef iterator const_iterator;
+			typedef std::size_t size_type;
+
+			direction_range(iterator first, iterator last) noexcept
+				: _first(first), _last(last) {}
+
+			iterator begin() const noexcept { return _first; }
+			iterator end() const noexcept { return _last; }
+			size_type size() const noexcept { return static_cast<size_type>(_last - _first); }
+			bool empty() const noexcept { return _first == _last; }
+
+		private:
+			iterator _first, _last;
+		};
+	}
+
+	/// lazy half-open range of angles start, start + step, ... up to stop.
+	/// elements are computed from their index rather than accumulated, and
+	/// sub-ranges keep the indices of the parent range so they may be handed
+	/// to separate workers.
+	template <typename _T, typename _Traits = radian_traits<_T>>
+	struct basic_angle_range {
+
+		////////////////////////////////////////////////////////////////////////////////
+		// type definitions.
+
+		typedef basic_angle<_T, _Traits> angle_type;
+		typedef angle_type value_type;
+		typedef std::size_t size_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef typename std::common_type<_T, float>::type direction_value_type;
+
+		/// random access operations over computed values; the category is input
+		/// iterator since dereferencing yields a value, not a reference.
+		struct iterator {
+			typedef std::input_iterator_tag iterator_category;
+			typedef angle_type value_type;
+			typedef std::ptrdiff_t difference_type;
+			typedef angle_type const* pointer;
+			typedef angle_type reference;
+
+			iterator() noexcept : _start(0), _step(0), _index(0) {}
+			iterator(angle_type const& start, angle_type const& step, size_type index) noexcept
+				: _start(start.value()), _step(step.value()), _index(index) {}
+
+			reference operator *() const noexcept { return _at(_start, _step, _index); }
+			reference operator [](difference_type n) const noexcept { return _at(_start, _step, _index + n); }
+
+			iterator& operator ++() noexcept { ++_index; return *this; }
+			iterator& operator --() noexcept { --_index; return *this; }
+			iterator operator ++(int) noexcept { iterator tmp(*this); ++_index; return tmp; }
+			iterator operator --(int) noexcept { iterator tmp(*this); --_index; return tmp; }
+			iterator& operator += (difference_type n) noexcept { _index += n; return *this; }
+			iterator& operator -= (difference_type n) noexcept { _index -= n; return *this; }
+
+			friend iterator operator + (iterator it, difference_type n) noexcept { return it += n; }
+			friend iterator operator + (difference_type n, iterator it) noexcept { return it += n; }
+			friend iterator operator - (iterator it, difference_type n) noexcept { return it -= n; }
+
+			friend difference_type operator - (iterator const& lhs, iterator const& rhs) noexcept {
+				return static_cast<difference_type>(lhs._index) - static_cast<difference_type>(rhs._index);
+			}
+
+			friend bool operator == (iterator const& lhs, iterator const& rhs) noexcept { return lhs._index == rhs._index; }
+			friend bool operator != (iterator const& lhs, iterator const& rhs) noexcept { return lhs._index != rhs._index; }
+			friend bool operator < (iterator const& lhs, iterator const& rhs) noexcept { return lhs._index < rhs._index; }
+			friend bool operator > (iterator const& lhs, iterator const& rhs) noexcept { return rhs < lhs; }
+			friend bool operator <= (iterator const& lhs, iterator const& rhs) noexcept { return !(rhs < lhs); }
+			friend bool operator >= (iterator const& lhs, iterator const& rhs) noexcept { return !(lhs < rhs); }
+
+		private:
+			_T _start, _step;
+			size_type _index;
+		};
+
+		typedef iterator const_iterator;
+
+		////////////////////////////////////////////////////////////////////////////////
+		// constructors.
+
+		basic_angle_range(angle_type const& start, angle_type const& stop, angle_type const& step) noexcept
+			: _start(start), _step(step), _first(0), _last(_count(start, stop, step)) {}
+
+		////////////////////////////////////////////////////////////////////////////////
+		// accessor methods.
+
+		size_type size() const noexcept { return _last - _first; }
+		bool empty() const noexcept { return _last == _first; }
+
+		angle_type operator [](size_type index) const noexcept { return _at(_start.value(), _step.value(), _first + index); }
+		angle_type front() const noexcept { return (*this)[0]; }
+		angle_type back() const noexcept { return (*this)[size() - 1]; }
+		angle_type step() const noexcept { return _step; }
+
+		////////////////////////////////////////////////////////////////////////////////
+		// partitioning.
+
+		/// the count elements starting at pos, clamped to the range.
+		basic_angle_range subrange(size_type pos, size_type count) const noexcept {
+			basic_angle_range result(*this);
+			result._first = _first + std::min(pos, size());
+			result._last = result._first + std::min(count, static_cast<size_type>(_last - result._first));
+			return result;
+		}
+
+		/// the index-th of count near-equal pieces, for splitting the range
+		/// between workers.
+		basic_angle_range chunk(size_type index, size_type count) const noexcept {
+			size_type const n = size();
+			size_type const first = n / count * index + std::min(index, n % count);
+			size_type const length = n / count + (index < n % count ? 1 : 0);
+			return subrange(first, length);
+		}
+
+		////////////////////////////////////////////////////////////////////////////////
+		// directions.
+
+		/// unit vector2 directions for each angle in the range.
+		internal::direction_range<direction_value_type, 2> directions() const noexcept {
+			return _directions<2>(direction_value_type(1), direction_value_type(0));
+		}
+
+		/// unit vector3 directions sweeping the azimuth at a fixed polar angle
+		/// theta, as in the vector3(theta, phi) constructor.
+		template <typename _T2, typename _Traits2>
+		internal::direction_range<direction_value_type, 3> directions(basic_angle<_T2, _Traits2> const& theta) const noexcept {
+			direction_value_type polar_sin, polar_cos;
+			internal::fast_sincos(radians<direction_value_type>(theta).value(), polar_sin, polar_cos);
+			return _directions<3>(polar_sin, polar_cos);
+		}
+
+		////////////////////////////////////////////////////////////////////////////////
+		// iteration.
+
+		iterator begin() const noexcept { return iterator(_start, _step, _first); }
+		iterator end() const noexcept { return iterator(_start, _step, _last); }
+		const_iterator cbegin() const noexcept { return begin(); }
+		const_iterator cend() const noexcept { return end(); }
+
+	private:
+		angle_type _start, _step;
+		size_type _first, _last;
+
+		static angle_type _at(_T start, _T step, size_type index) noexcept {
+			return angle_type { start + static_cast<_T>(index) * step };
+		}
+
+		static size_type _count(angle_type const& start, angle_type const& stop, angle_type const& step) noexcept {
+			if (step.value() == _T(0)) return 0;
+			auto const n = std::ceil((stop.value() - start.value()) / static_cast<direction_value_type>(step.value()));
+			return n > 0 ? static_cast<size_type>(n) : 0;
+		}
+
+		template <std::size_t _N>
+		internal::direction_range<direction_value_type, _N> _directions(direction_value_type polar_sin, direction_value_type polar_cos) const noexcept {
+			typedef internal::direction_iterator<direction_value_type, _N> iterator_t;
+			direction_value_type const start = radians<direction_value_type>(_start).value();
+			direction_value_type const step = radians<direction_value_type>(_step).value();
+			return internal::direction_range<direction_value_type, _N>(
+				iterator_t(start, step, _first, polar_sin, polar_cos),
+				iterator_t(start, step, _last, polar_sin, polar_cos));
+		}
+	};
+
+	////////////////////////////////////////////////////////////////////////////////
+	// helper functions.
+
+	template <typename _T, typename _Traits>
+	basic_angle_range<_T, _Traits> angle_range(
+		basic_angle<_T, _Traits> const& start,
+		basic_angle<_T, _Traits> const& stop,
+		basic_angle<_T, _Traits> const& step) noexcept {
+			return basic_angle_range<_T, _Traits>(start, stop, step);
+		}
+}
+
+#endif // _MATH_ANGLE_RANGE_HPP
@@ -0,0 +1,201 @@
+#ifndef _MATH_CIRCULAR_HPP
+#define _MATH_CIRCULAR_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+#include <type_traits>
+
+#include "angle.hpp"
+#include "vector.hpp"
+#include "kernels.hpp"
+
+namespace math {
+
+	/// single-pass statistics of angles on the circle. every sample adds its
+	/// (weighted) unit vector (cos a, sin a) to a running resultant, so the
+	/// mean is correct across the wrap point and two accumulators merge by
+	/// adding their sums; per-thread partials can be combined in any order.
+	/// sums are kept in at least double precision.
+	template <typename _T, typename _Traits = radian_traits<_T>>
+	struct circular_accumulator {
+
+		////////////////////////////////////////////////////////////////////////////////
+		// type definitions.
+
+		typedef basic_angle<_T, _Traits> angle_type;
+		typedef typename std::common_type<_T, float>::type value_type;
+		typedef typename std::common_type<_T, double>::type sum_type;
+		typedef std::size_t size_type;
+
+		static_assert(std::is_floating_point<value_type>::value,
+			"circular_accumulator<T> requires floating point or integral type.");
+
+		/// samples converted and evaluated together by the batch overloads.
+		static constexpr size_type block_size = 256;
+
+		////////////////////////////////////////////////////////////////////////////////
+		// constructors.
+
+		constexpr circular_accumulator() noexcept
+			: _count(0), _weight(0), _cos(0), _sin(0) {}
+
+		template <typename _InputIt>
+		circular_accumulator(_InputIt first, _InputIt last)
+			: circular_accumulator() { add(first, last); }
+
+		////////////////////////////////////////////////////////////////////////////////
+		// accumulation.
+
+		template <typename _T2, typename _Traits2>
+		void add(basic_angle<_T2, _Traits2> const& angle) noexcept {
+			add(angle, value_type(1));
+		}
+
+		template <typename _T2, typename _Traits2>
+		void add(basic_angle<_T2, _Traits2> const& angle, value_type weight) noexcept {
+			value_type s, c;
+			internal::fast_sincos(radians<value_type>(angle).value(), s, c);
+			_count += 1;
+			_weight += weight;
+			_cos += static_cast<sum_type>(weight) * c;
+			_sin += static_cast<sum_type>(weight) * s;
+		}
+
+		/// adds every angle in [first, last).
+		template <typename _InputIt>
+		void add(_InputIt first, _InputIt last) {
+			value_type x[block_size];
+			while (first != last) {
+				size_type n = 0;
+				for (; n < block_size && first != last; ++n, ++first)
+					x[n] = radians<value_type>(*first).value();
+				_add_block(x, nullptr, n);
+			}
+		}
+
+		/// adds every angle in [first, last) with the matching weight.
+		template <typename _InputIt1, typename _InputIt2>
+		void add(_InputIt1 first, _InputIt1 last, _InputIt2 weight_first) {
+			value_type x[block_size], w[block_size];
+			while (first != last) {
+				size_type n = 0;
+				for (; n < block_size && first != last; ++n, ++first, ++weight_first) {
+					x[n] = radians<value_type>(*first).value();
+					w[n] = static_cast<value_type>(*weight_first);
+				}
+				_add_block(x, w, n);
+			}
+		}
+
+		/// combines the samples of other into this accumulator.
+		circular_accumulator& merge(circular_accumulator const& other) noexcept {
+			_count += other._count;
+			_weight += other._weight;
+			_cos += other._cos;
+			_sin += other._sin;
+			return *this;
+		}
+
+		circular_accumulator& operator += (circular_accumulator const& other) noexcept {
+			return merge(other);
+		}
+
+		void reset() noexcept {
+			*this = circular_accumulator();
+		}
+
+		////////////////////////////////////////////////////////////////////////////////
+		// accessor methods.
+
+		size_type count() const noexcept { return _count; }
+		bool empty() const noexcept { return _count == 0; }
+		sum_type weight() const noexcept { return _weight; }
+
+		/// sum of the weighted unit vectors.
+		vector2<sum_type> resultant() const noexcept {
+			return vector2<sum_type> { _cos, _sin };
+		}
+
+		////////////////////////////////////////////////////////////////////////////////
+		// statistics.
+
+		/// direction of the resultant, in (-pi, pi]. zero when the resultant
+		/// vanishes (no samples, or samples spread evenly round the circle).
+		angle_type mean() const noexcept {
+			return _angle(std::atan2(_sin, _cos));
+		}
+
+		/// length of the mean resultant, from 0 (spread out) to 1 (all equal).
+		/// the sines and cosines carry rounding error, so equal samples can sum
+		/// to slightly more than their weight; the length is clamped to 1.
+		sum_type resultant_length() const noexcept {
+			return _weight > sum_type(0) ? std::min(sum_type(1), std::sqrt(_cos * _cos + _sin * _sin) / _weight) : sum_type(0);
+		}
+
+		/// circular variance, 1 - resultant_length(), in [0, 1].
+		sum_type variance() const noexcept {
+			return sum_type(1) - resultant_length();
+		}
+
+		/// circular standard deviation, sqrt(-2 ln resultant_length()), written
+		/// as sqrt(2 ln(1 / r)) so that equal samples give +0 rather than -0.
+		angle_type standard_deviation() const noexcept {
+			return _angle(std::sqrt(sum_type(2) * std::log(sum_type(1) / resultant_length())));
+		}
+
+	private:
+		size_type _count;
+		sum_type _weight;
+		sum_type _cos;
+		sum_type _sin;
+
+		/// converts from radians at full width before narrowing to _T.
+		static angle_type _angle(sum_type radians_value) noexcept {
+			basic_angle<sum_type, _Traits> const angle = radians<sum_type> { radians_value };
+			return angle_type { static_cast<_T>(angle.value()) };
+		}
+
+		/// zero pads x to block_size and evaluates the whole block with the
+		/// branch-free kernel into separate arrays (the constant trip count
+		/// lets that loop vectorize at -O2), then sums the first n at sum_type
+		/// width; weights may be null.
+		void _add_block(value_type* x, value_type const* w, size_type n) noexcept {
+			value_type s[block_size], c[block_size];
+			for (size_type i = n; i < block_size; ++i) x[i] = value_type(0);
+			for (size_type i = 0; i < block_size; ++i) internal::fast_sincos(x[i], s[i], c[i]);
+
+			sum_type block_weight = static_cast<sum_type>(n), block_cos(0), block_sin(0);
+			if (w) {
+				block_weight = sum_type(0);
+				for (size_type i = 0; i < n; ++i) {
+					sum_type const weight = w[i];
+					block_weight += weight;
+					block_cos += weight * c[i];
+					block_sin += weight * s[i];
+				}
+			}
+			else {
+				for (size_type i = 0; i < n; ++i) {
+					block_cos += c[i];
+					block_sin += s[i];
+				}
+			}
+
+			_count += n;
+			_weight += block_weight;
+			_cos += block_cos;
+			_sin += block_sin;
+		}
+	};
+
+	template <typename _T, typename _Traits>
+	constexpr typename circular_accumulator<_T, _Traits>::size_type circular_accumulator<_T, _Traits>::block_size;
+
+	template <typename _T, typename _Traits>
+	inline circular_accumulator<_T, _Traits> operator + (circular_accumulator<_T, _Traits> lhs, circular_accumulator<_T, _Traits> const& rhs) noexcept {
+		return lhs += rhs;
+	}
+}
+
+#endif // _MATH_CIRCULAR_HPP
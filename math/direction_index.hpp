@@ -0,0 +1,269 @@
+#ifndef _MATH_DIRECTION_INDEX_HPP
+#define _MATH_DIRECTION_INDEX_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+#include <thread>
+#include <numeric>
+#include <algorithm>
+#include <type_traits>
+
+#include "vector.hpp"
+
+namespace math {
+
+	/// nearest-direction search over a fixed set of vectors.
+	/// directions are normalised once when the index is built and stored as
+	/// one contiguous array per component, so ranking a candidate costs a single
+	/// dot product. with a non-zero resolution the directions are bucketed into
+	/// cube-map cells (2 * _N faces, resolution^(_N - 1) cells per face); each
+	/// cell keeps a bounding cone, and cells that cannot beat the current k-th
+	/// best similarity are skipped.
+	template <typename _T, std::size_t _N = 3>
+	struct direction_index {
+		static_assert(std::is_floating_point<_T>::value,
+			"direction_index<T, N> requires floating point type.");
+
+		////////////////////////////////////////////////////////////////////////////////
+		// type definitions.
+
+		typedef _T value_type;
+		typedef vector<_T, _N> vector_type;
+		typedef std::size_t size_type;
+
+		struct match {
+			size_type index;		// position of the direction in the input sequence.
+			value_type similarity;	// cosine of the angle to the query.
+		};
+
+		static constexpr size_type block_size = 64;
+
+		////////////////////////////////////////////////////////////////////////////////
+		// constructors.
+
+		direction_index() noexcept
+			: _resolution(0) {}
+
+		template <typename _InputIt>
+		direction_index(_InputIt first, _InputIt last, size_type resolution = 0)
+			: _resolution(resolution) {
+				std::vector<vector_type> directions;
+				for (; first != last; ++first) {
+					vector_type v = static_cast<vector_type>(*first);
+					_T const length = v.length();
+					if (length > _T(0)) v /= length;
+					directions.push_back(v);
+				}
+				_build(directions);
+			}
+
+		////////////////////////////////////////////////////////////////////////////////
+		// accessor methods.
+
+		size_type size() const noexcept { return _ids.size(); }
+		bool empty() const noexcept { return _ids.empty(); }
+		size_type resolution() const noexcept { return _resolution; }
+
+		////////////////////////////////////////////////////////////////////////////////
+		// queries.
+
+		/// the k stored directions most similar to query, best first.
+		template <typename _T2>
+		std::vector<match> nearest(vector<_T2, _N> const& query, size_type k) const {
+			std::vector<match> heap;
+			std::vector<_cell_bound> order;
+			_search(_normalise(query), k, heap, order);
+			return heap;
+		}
+
+		/// runs nearest() for every query in [first, last) across threads
+		/// workers; zero uses the hardware concurrency.
+		template <typename _InputIt>
+		std::vector<std::vector<match>> nearest(_InputIt first, _InputIt last, size_type k, unsigned threads = 0) const {
+			std::vector<vector_type> queries;
+			for (; first != last; ++first) queries.push_back(_normalise(*first));
+
+			std::vector<std::vector<match>> results(queries.size());
+			if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+			size_type const workers = std::max<size_type>(1, std::min<size_type>(threads, queries.size()));
+
+			auto const work = [&](size_type w) {
+				std::vector<_cell_bound> order;
+				size_type const begin = queries.size() * w / workers;
+				size_type const end = queries.size() * (w + 1) / workers;
+				for (size_type i = begin; i != end; ++i)
+					_search(queries[i], k, results[i], order);
+			};
+
+			std::vector<std::thread> pool;
+			for (size_type w = 1; w < workers; ++w) pool.emplace_back(work, w);
+			work(0);
+			for (auto& t : pool) t.join();
+			return results;
+		}
+
+	private:
+		struct _cell {
+			size_type first, last;
+			vector_type axis;
+			_T cos_radius, sin_radius;
+		};
+
+		struct _cell_bound {
+			_T bound;
+			_cell const* cell;
+		};
+
+		size_type _resolution;
+		std::vector<_T> _components[_N];
+		std::vector<size_type> _ids;
+		std::vector<_cell> _cells;
+
+		template <typename _T2>
+		static vector_type _normalise(vector<_T2, _N> const& v) {
+			vector_type result = static_cast<vector_type>(v);
+			_T const length = result.length();
+			if (length > _T(0)) result /= length;
+			return result;
+		}
+
+		static bool _better(match const& lhs, match const& rhs) noexcept {
+			return lhs.similarity > rhs.similarity;
+		}
+
+		size_type _cell_key(vector_type const& v) const noexcept {
+			if (_resolution == 0) return 0;
+
+			size_type axis = 0;
+			for (size_type i = 1; i < _N; ++i)
+				if (std::abs(v[i]) > std::abs(v[axis])) axis = i;
+
+			_T const major = std::abs(v[axis]);
+			size_type key = axis * 2 + (v[axis] < _T(0) ? 1 : 0);
+			for (size_type i = 0; i < _N; ++i) {
+				if (i == axis) continue;
+				_T const u = major > _T(0) ? (v[i] / major + _T(1)) * _T(0.5) : _T(0.5);
+				size_type const cell = static_cast<size_type>(u * static_cast<_T>(_resolution));
+				key = key * _resolution + std::min(cell, _resolution - 1);
+			}
+			return key;
+		}
+
+		void _build(std::vector<vector_type> const& directions) {
+			size_type cell_count = 2 * _N;
+			for (size_type i = 1; i < _N; ++i) cell_count *= std::max<size_type>(_resolution, 1);
+			if (_resolution == 0) cell_count = 1;
+
+			// counting sort by cell so every cell is a contiguous run.
+			std::vector<size_type> keys(directions.size());
+			std::vector<size_type> offsets(cell_count + 1, 0);
+			for (size_type i = 0; i != directions.size(); ++i)
+				++offsets[(keys[i] = _cell_key(directions[i])) + 1];
+			std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+			for (auto& c : _components) c.resize(directions.size());
+			_ids.resize(directions.size());
+
+			std::vector<size_type> cursor(offsets.begin(), offsets.end() - 1);
+			for (size_type i = 0; i != directions.size(); ++i) {
+				size_type const slot = cursor[keys[i]]++;
+				for (size_type d = 0; d < _N; ++d) _components[d][slot] = directions[i][d];
+				_ids[slot] = i;
+			}
+
+			for (size_type key = 0; key != cell_count; ++key) {
+				if (offsets[key] == offsets[key + 1]) continue;
+
+				_cell cell;
+				cell.first = offsets[key];
+				cell.last = offsets[key + 1];
+
+				vector_type sum;
+				std::fill(sum.begin(), sum.end(), _T(0));
+				for (size_type i = cell.first; i != cell.last; ++i)
+					for (size_type d = 0; d < _N; ++d) sum[d] += _components[d][i];
+
+				_T const length = sum.length();
+				cell.cos_radius = _T(-1);
+				if (length > _T(0)) {
+					cell.axis = sum / length;
+					cell.cos_radius = _T(1);
+					for (size_type i = cell.first; i != cell.last; ++i) {
+						_T dot = _T(0);
+						for (size_type d = 0; d < _N; ++d) dot += cell.axis[d] * _components[d][i];
+						cell.cos_radius = std::min(cell.cos_radius, dot);
+					}
+				}
+				else {
+					cell.axis = sum;
+				}
+				cell.sin_radius = std::sqrt(std::max(_T(0), _T(1) - cell.cos_radius * cell.cos_radius));
+				_cells.push_back(cell);
+			}
+		}
+
+		void _scan(vector_type const& query, _cell const& cell, size_type k, std::vector<match>& heap) const {
+			_T dots[block_size];
+			for (size_type first = cell.first; first < cell.last; first += block_size) {
+				size_type const count = std::min(block_size, cell.last - first);
+
+				std::fill(dots, dots + count, _T(0));
+				for (size_type d = 0; d < _N; ++d) {
+					_T const q = query[d];
+					_T const* component = _components[d].data() + first;
+					for (size_type i = 0; i < count; ++i) dots[i] += q * component[i];
+				}
+
+				_T threshold = heap.size() < k ? -std::numeric_limits<_T>::infinity() : heap.front().similarity;
+				for (size_type i = 0; i < count; ++i) {
+					if (!(dots[i] > threshold)) continue;
+					if (heap.size() == k) {
+						std::pop_heap(heap.begin(), heap.end(), &_better);
+						heap.pop_back();
+					}
+					heap.push_back(match { _ids[first + i], dots[i] });
+					std::push_heap(heap.begin(), heap.end(), &_better);
+					if (heap.size() == k) threshold = heap.front().similarity;
+				}
+			}
+		}
+
+		void _search(vector_type const& query, size_type k, std::vector<match>& heap, std::vector<_cell_bound>& order) const {
+			heap.clear();
+			if (k == 0) return;
+			heap.reserve(k);
+
+			// upper bound on the similarity of anything inside each cell's cone:
+			// cos(max(0, angle(query, axis) - radius)).
+			order.clear();
+			for (auto const& cell : _cells) {
+				_T cos_angle = _T(0);
+				for (size_type d = 0; d < _N; ++d) cos_angle += query[d] * cell.axis[d];
+				_T bound = _T(1);
+				if (cos_angle < cell.cos_radius) {
+					_T const sin_angle = std::sqrt(std::max(_T(0), _T(1) - cos_angle * cos_angle));
+					bound = cos_angle * cell.cos_radius + sin_angle * cell.sin_radius;
+				}
+				order.push_back(_cell_bound { bound, &cell });
+			}
+			std::sort(order.begin(), order.end(),
+				[](_cell_bound const& a, _cell_bound const& b) { return a.bound > b.bound; });
+
+			// the slack absorbs rounding in the cone radii.
+			_T const slack = std::numeric_limits<_T>::epsilon() * _T(4);
+			for (auto const& entry : order) {
+				if (heap.size() == k && entry.bound + slack < heap.front().similarity) break;
+				_scan(query, *entry.cell, k, heap);
+			}
+
+			std::sort_heap(heap.begin(), heap.end(), &_better);
+		}
+	};
+
+	template <typename _T, std::size_t _N>
+	constexpr typename direction_index<_T, _N>::size_type direction_index<_T, _N>::block_size;
+}
+
+#endif // _MATH_DIRECTION_INDEX_HPP
@@ -0,0 +1,486 @@
+#ifndef _MATH_DYNAMIC_MATRIX_HPP
+#define _MATH_DYNAMIC_MATRIX_HPP
+
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <thread>
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+
+#include "matrix.hpp"
+#include "memory.hpp"
+
+namespace math {
+
+	namespace internal {
+
+		////////////////////////////////////////////////////////////////////////////////
+		// general matrix multiply.
+		// c += a * b for an m x k matrix a and a k x n matrix b, each accessed
+		// through operator ()(row, column). b is packed into kc x nc panels of
+		// nr wide slivers and a into mc x kc blocks of mr tall slivers, both
+		// contiguous in k, so the kernel streams through two small buffers that
+		// stay in cache while it updates an mr x nr tile held in registers.
+
+		constexpr std::size_t gemm_kc = 256;
+		constexpr std::size_t gemm_mc = 128;
+		constexpr std::size_t gemm_nc = 2048;
+
+		/// products below this many multiply-adds run on the calling thread.
+		constexpr std::size_t gemm_parallel_threshold = std::size_t(1) << 18;
+
+		/// uninitialized aligned scratch for packed panels; the pack functions
+		/// write every element before the kernel reads it.
+		template <typename _T>
+		struct gemm_buffer {
+			explicit gemm_buffer(std::size_t size)
+				: data(static_cast<_T*>(aligned_allocate(size * sizeof(_T), buffer_alignment))) {}
+			~gemm_buffer() { aligned_deallocate(data); }
+
+			gemm_buffer(gemm_buffer const&) = delete;
+			gemm_buffer& operator = (gemm_buffer const&) = delete;
+
+			_T* data;
+		};
+
+		/// portable kernel. the tile is accumulated in a local array, as writing
+		/// through tile directly would have to assume it aliases a or b.
+		template <typename _T>
+		struct gemm_kernel {
+			static constexpr std::size_t mr = 4;
+			static constexpr std::size_t nr = 4;
+
+			static void run(std::size_t kc, _T const* a, _T const* b, _T* tile) noexcept {
+				_T acc[mr * nr] = {};
+				for (std::size_t p = 0; p < kc; ++p, a += mr, b += nr)
+					for (std::size_t j = 0; j < nr; ++j)
+						for (std::size_t i = 0; i < mr; ++i) acc[j * mr + i] += a[i] * b[j];
+				for (std::size_t i = 0; i < mr * nr; ++i) tile[i] = acc[i];
+			}
+		};
+
+#if defined(__GNUC__)
+		/// two vector registers of a by four columns of b, unrolled by hand so
+		/// the eight accumulators stay in registers at any optimisation level.
+		/// the registers are 16 bytes whatever the target: every translation
+		/// unit, and the precompiled multiply in the library, must see the same
+		/// definition, so the tile shape cannot follow -mavx and the like.
+		template <typename _T>
+		struct gemm_simd_kernel {
+			static constexpr std::size_t width = 16 / sizeof(_T);
+			static constexpr std::size_t mr = 2 * width;
+			static constexpr std::size_t nr = 4;
+
+			typedef _T vector_t __attribute__((vector_size(width * sizeof(_T))));
+
+			static void run(std::size_t kc, _T const* a, _T const* b, _T* tile) noexcept {
+				vector_t c00 = {}, c01 = {}, c10 = {}, c11 = {}, c20 = {}, c21 = {}, c30 = {}, c31 = {};
+				for (std::size_t p = 0; p < kc; ++p, a += mr, b += nr) {
+					vector_t a0, a1;
+					std::memcpy(&a0, a, sizeof(vector_t));
+					std::memcpy(&a1, a + width, sizeof(vector_t));
+					c00 += a0 * b[0]; c01 += a1 * b[0];
+					c10 += a0 * b[1]; c11 += a1 * b[1];
+					c20 += a0 * b[2]; c21 += a1 * b[2];
+					c30 += a0 * b[3]; c31 += a1 * b[3];
+				}
+				vector_t const acc[] = { c00, c01, c10, c11, c20, c21, c30, c31 };
+				std::memcpy(tile, acc, sizeof(acc));
+			}
+		};
+
+		template <> struct gemm_kernel<float> : gemm_simd_kernel<float> {};
+		template <> struct gemm_kernel<double> : gemm_simd_kernel<double> {};
+#endif
+
+		/// rows [r0, r0 + mc) by depth [p0, p0 + kc) of a, zero padded to whole slivers.
+		template <typename _T, typename _A>
+		void gemm_pack_a(_A const& a, std::size_t r0, std::size_t mc, std::size_t p0, std::size_t kc, _T* out) {
+			std::size_t const mr = gemm_kernel<_T>::mr;
+			for (std::size_t i0 = 0; i0 < mc; i0 += mr) {
+				std::size_t const rows = std::min(mr, mc - i0);
+				for (std::size_t p = 0; p < kc; ++p, out += mr) {
+					for (std::size_t i = 0; i < rows; ++i) out[i] = static_cast<_T>(a(r0 + i0 + i, p0 + p));
+					for (std::size_t i = rows; i < mr; ++i) out[i] = _T(0);
+				}
+			}
+		}
+
+		/// depth [p0, p0 + kc) by columns [c0, c0 + nc) of b, zero padded to whole slivers.
+		template <typename _T, typename _B>
+		void gemm_pack_b(_B const& b, std::size_t p0, std::size_t kc, std::size_t c0, std::size_t nc, _T* out) {
+			std::size_t const nr = gemm_kernel<_T>::nr;
+			for (std::size_t j0 = 0; j0 < nc; j0 += nr) {
+				std::size_t const columns = std::min(nr, nc - j0);
+				for (std::size_t p = 0; p < kc; ++p, out += nr) {
+					for (std::size_t j = 0; j < columns; ++j) out[j] = static_cast<_T>(b(p0 + p, c0 + j0 + j));
+					for (std::size_t j = columns; j < nr; ++j) out[j] = _T(0);
+				}
+			}
+		}
+
+		/// the product restricted to columns [first, last) of c.
+		template <typename _T, typename _A, typename _B, typename _C>
+		void gemm_columns(std::size_t m, std::size_t k, std::size_t first, std::size_t last, _A const& a, _B const& b, _C& c) {
+			typedef gemm_kernel<_T> kernel_t;
+			std::size_t const mr = kernel_t::mr;
+			std::size_t const nr = kernel_t::nr;
+
+			// sized for the largest blocks this product uses, with mc and nc
+			// rounded up to whole slivers.
+			std::size_t const kc_max = std::min(gemm_kc, k);
+			gemm_buffer<_T> packed_a((std::min(gemm_mc, m) + mr - 1) / mr * mr * kc_max);
+			gemm_buffer<_T> packed_b((std::min(gemm_nc, last - first) + nr - 1) / nr * nr * kc_max);
+			_T tile[kernel_t::mr * kernel_t::nr];
+
+			for (std::size_t jc = first; jc < last; jc += gemm_nc) {
+				std::size_t const nc = std::min(gemm_nc, last - jc);
+				for (std::size_t pc = 0; pc < k; pc += gemm_kc) {
+					std::size_t const kc = std::min(gemm_kc, k - pc);
+					gemm_pack_b(b, pc, kc, jc, nc, packed_b.data);
+
+					for (std::size_t ic = 0; ic < m; ic += gemm_mc) {
+						std::size_t const mc = std::min(gemm_mc, m - ic);
+						gemm_pack_a(a, ic, mc, pc, kc, packed_a.data);
+
+						for (std::size_t jr = 0; jr < nc; jr += nr) {
+							std::size_t const columns = std::min(nr, nc - jr);
+							for (std::size_t ir = 0; ir < mc; ir += mr) {
+								std::size_t const rows = std::min(mr, mc - ir);
+								kernel_t::run(kc, packed_a.data + ir * kc, packed_b.data + jr * kc, tile);
+								for (std::size_t j = 0; j < columns; ++j)
+									for (std::size_t i = 0; i < rows; ++i)
+										c(ic + ir + i, jc + jr + j) += tile[j * mr + i];
+							}
+						}
+					}
+				}
+			}
+		}
+
+		/// splits the columns of c across threads workers (zero uses the
+		/// hardware concurrency); every worker packs its own panels. if a
+		/// thread cannot be started the calling thread does its share, and an
+		/// exception in any worker is rethrown here once all have joined.
+		template <typename _T, typename _A, typename _B, typename _C>
+		void gemm(std::size_t m, std::size_t n, std::size_t k, _A const& a, _B const& b, _C& c, unsigned threads) {
+			if (m == 0 || n == 0 || k == 0) return;
+
+			std::size_t const nr = gemm_kernel<_T>::nr;
+			if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+			std::size_t const slivers = (n + nr - 1) / nr;
+			std::size_t workers = std::min<std::size_t>(threads, slivers);
+			if (m * n * k < gemm_parallel_threshold) workers = 1;
+
+			std::vector<std::exception_ptr> errors(workers);
+			auto const work = [&](std::size_t w) {
+				std::size_t const first = std::min(n, slivers * w / workers * nr);
+				std::size_t const last = std::min(n, slivers * (w + 1) / workers * nr);
+				try {
+					gemm_columns<_T>(m, k, first, last, a, b, c);
+				}
+				catch (...) {
+					errors[w] = std::current_exception();
+				}
+			};
+
+			std::vector<std::thread> pool;
+			std::size_t started = 1;
+			try {
+				pool.reserve(workers - 1);
+				for (; started < workers; ++started) pool.emplace_back(work, started);
+			}
+			catch (...) {}
+			for (std::size_t w = started; w < workers; ++w) work(w);
+			work(0);
+			for (auto& t : pool) t.join();
+
+			for (auto const& error : errors)
+				if (error) std::rethrow_exception(error);
+		}
+	}
+
+	/// matrix whose size is chosen at run time, stored on the heap. it has
+	/// the element-wise operators and the square matrix operations of
+	/// matrix<_T, _M, _N, _Order>, with the same meaning of columns and rows,
+	/// and multiplies through the blocked internal::gemm.
+	template <typename _T, typename _Order = column_major>
+	struct dynamic_matrix {
+		static_assert(math::is_arithmetic<_T>::value,
+			"dynamic_matrix<T> requires arithmetic type.");
+
+		typedef _T value_type;
+		typedef _T* pointer;
+		typedef _T& reference;
+		typedef _T const* const_pointer;
+		typedef _T const& const_reference;
+		typedef std::size_t size_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef _Order order_type;
+
+		typedef _T* iterator;
+		typedef _T const* const_iterator;
+		typedef std::reverse_iterator<iterator> reverse_iterator;
+		typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+		////////////////////////////////////////////////////////////////////////////////
+		// constructors.
+
+		dynamic_matrix() noexcept
+			: _columns(0), _rows(0) {}
+
+		dynamic_matrix(size_type columns, size_type rows, value_type const& value = value_type())
+			: _columns(columns), _rows(rows), _data(columns * rows, value) {}
+
+		template <typename _T2, std::size_t _M, std::size_t _N, typename _Order2>
+		dynamic_matrix(matrix<_T2, _M, _N, _Order2> const& other)
+			: dynamic_matrix(_M, _N) {
+				for (size_type c = 0; c < _M; ++c)
+					for (size_type r = 0; r < _N; ++r)
+						(*this)(r, c) = static_cast<_T>(other(r, c));
+			}
+
+		/// converts the value type and/or the storage order.
+		template <typename _T2, typename _Order2>
+		dynamic_matrix(dynamic_matrix<_T2, _Order2> const& other)
+			: dynamic_matrix(other.columns(), other.rows()) {
+				for (size_type c = 0; c < _columns; ++c)
+					for (size_type r = 0; r < _rows; ++r)
+						(*this)(r, c) = static_cast<_T>(other(r, c));
+			}
+
+		static dynamic_matrix identity(size_type size) {
+			dynamic_matrix result(size, size);
+			for (size_type i = 0; i < size; ++i) result(i, i) = static_cast<_T>(1);
+			return result;
+		}
+
+		////////////////////////////////////////////////////////////////////////////////
+		// element access.
+
+		reference operator ()(size_type row, size_type column) noexcept {
+			return _data[_Order::offset(row, column, _rows, _columns)];
+		}
+
+		const_reference operator ()(size_type row, size_type column) const noexcept {
+			return _data[_Order::offset(row, column, _rows, _columns)];
+		}
+
+		size_type columns() const noexcept { return _columns; }
+		size_type rows() const noexcept { return _rows; }
+		size_type size() const noexcept { return _data.size(); }
+		bool empty() const noexcept { return _data.empty(); }
+
+		difference_type row_stride() const noexcept { return _Order::row_stride(_rows, _columns); }
+		difference_type column_stride() const noexcept { return _Order::column_stride(_rows, _columns); }
+
+		////////////////////////////////////////////////////////////////////////////////
+		// unary arithmetic operators.
+
+		dynamic_matrix operator +() const {
+			return *this;
+		}
+
+		dynamic_matrix operator -() const {
+			dynamic_matrix result(_columns, _rows);
+			for (size_type i = 0; i < _data.size(); ++i) result._data[i] = -_data[i];
+			return result;
+		}
+
+		////////////////////////////////////////////////////////////////////////////////
+		// compound arithmetic operators.
+
+		dynamic_matrix& operator += (dynamic_matrix const& other) {
+			_check_same_size(other, "dynamic_matrix<T>::operator += requires matrices of the same size.");
+			for (size_type i = 0; i < _data.size(); ++i) _data[i] += other._data[i];
+			return *this;
+		}
+
+		dynamic_matrix& operator -= (dynamic_matrix const& other) {
+			_check_same_size(other, "dynamic_matrix<T>::operator -= requires matrices of the same size.");
+			for (size_type i = 0; i < _data.size(); ++i) _data[i] -= other._data[i];
+			return *this;
+		}
+
+		dynamic_matrix& operator *= (dynamic_matrix const& other);
+
+		dynamic_matrix& operator *= (value_type const& scalar) noexcept {
+			for (auto& value : _data) value *= scalar;
+			return *this;
+		}
+
+		dynamic_matrix& operator /= (value_type const& scalar) noexcept {
+			for (auto& value : _data) value /= scalar;
+			return *this;
+		}
+
+		////////////////////////////////////////////////////////////////////////////////
+		// square matrix operations.
+		// as for matrix<_T, _M, _N>; a matrix that is not square throws
+		// std::invalid_argument.
+
+		typename std::common_type<_T, float>::type determinant() const {
+			typedef typename std::common_type<_T, float>::type work_t;
+			_check_square("dynamic_matrix<T>::determinant requires a square matrix.");
+			dynamic_matrix<work_t, _Order> a = *this;
+			return internal::determinant<dynamic_matrix<work_t, _Order>, work_t>(a, _rows);
+		}
+
+		dynamic_matrix inverse() const {
+			typedef typename std::common_type<_T, float>::type work_t;
+			_check_square("dynamic_matrix<T>::inverse requires a square matrix.");
+			dynamic_matrix<work_t, _Order> a = *this;
+			dynamic_matrix<work_t, _Order> result = dynamic_matrix<work_t, _Order>::identity(_rows);
+			internal::inverse<dynamic_matrix<work_t, _Order>, work_t>(a, result, _rows);
+			return result;
+		}
+
+		dynamic_matrix decompose() const {
+			typedef typename std::common_type<_T, float>::type work_t;
+			_check_square("dynamic_matrix<T>::decompose requires a square matrix.");
+			dynamic_matrix<work_t, _Order> a = *this;
+			internal::decompose<dynamic_matrix<work_t, _Order>, work_t>(a, _rows);
+			return a;
+		}
+
+		dynamic_matrix upper_decompose() const {
+			dynamic_matrix result = decompose();
+			internal::triangle<dynamic_matrix, _T>(result, _rows, true);
+			return result;
+		}
+
+		dynamic_matrix lower_decompose() const {
+			dynamic_matrix result = decompose();
+			internal::triangle<dynamic_matrix, _T>(result, _rows, false);
+			return result;
+		}
+
+		pointer data() noexcept { return _data.data(); }
+		const_pointer data() const noexcept { return _data.data(); }
+
+		iterator begin() noexcept { return _data.data(); }
+		iterator end() noexcept { return _data.data() + _data.size(); }
+		const_iterator begin() const noexcept { return _data.data(); }
+		const_iterator end() const noexcept { return _data.data() + _data.size(); }
+		const_iterator cbegin() const noexcept { return begin(); }
+		const_iterator cend() const noexcept { return end(); }
+
+		reverse_iterator rbegin() noexcept { return reverse_iterator(this->end()); }
+		reverse_iterator rend() noexcept { return reverse_iterator(this->begin()); }
+		const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(this->end()); }
+		const_reverse_iterator rend() const noexcept { return const_reverse_iterator(this->begin()); }
+		const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator(this->cend()); }
+		const_reverse_iterator crend() const noexcept { return const_reverse_iterator(this->cbegin()); }
+
+	private:
+		size_type _columns;
+		size_type _rows;
+		aligned_vector<_T> _data;
+
+		void _check_same_size(dynamic_matrix const& other, char const* message) const {
+			if (_columns != other._columns || _rows != other._rows) throw std::invalid_argument(message);
+		}
+
+		void _check_square(char const* message) const {
+			if (_columns != _rows) throw std::invalid_argument(message);
+		}
+	};
+
+	////////////////////////////////////////////////////////////////////////////////
+	// multiplication.
+
+	/// lhs * rhs using up to threads workers (zero uses the hardware
+	/// concurrency); small products stay on the calling thread. the result
+	/// takes the storage order of lhs.
+	template <typename _T1, typename _T2, typename _O1, typename _O2>
+	dynamic_matrix<typename std::common_type<_T1, _T2>::type, _O1> multiply(dynamic_matrix<_T1, _O1> const& lhs, dynamic_matrix<_T2, _O2> const& rhs, unsigned threads = 0) {
+		typedef typename std::common_type<_T1, _T2>::type common_t;
+		if (lhs.columns() != rhs.rows())
+			throw std::invalid_argument("multiply(dynamic_matrix<T>, dynamic_matrix<T>) requires lhs columns to match rhs rows.");
+
+		dynamic_matrix<common_t, _O1> result(rhs.columns(), lhs.rows());
+		internal::gemm<common_t>(lhs.rows(), rhs.columns(), lhs.columns(), lhs, rhs, result, threads);
+		return result;
+	}
+
+	template <typename _T, typename _Order>
+	dynamic_matrix<_T, _Order>& dynamic_matrix<_T, _Order>::operator *= (dynamic_matrix const& other) {
+		return *this = multiply(*this, other);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	// equality operators.
+
+	template <typename _T1, typename _T2, typename _O1, typename _O2>
+	bool operator == (dynamic_matrix<_T1, _O1> const& lhs, dynamic_matrix<_T2, _O2> const& rhs) {
+		if (lhs.columns() != rhs.columns() || lhs.rows() != rhs.rows()) return false;
+		for (std::size_t c = 0; c < lhs.columns(); ++c)
+			for (std::size_t r = 0; r < lhs.rows(); ++r)
+				if (!(lhs(r, c) == rhs(r, c))) return false;
+		return true;
+	}
+
+	template <typename _T1, typename _T2, typename _O1, typename _O2>
+	bool operator != (dynamic_matrix<_T1, _O1> const& lhs, dynamic_matrix<_T2, _O2> const& rhs) {
+		return !(lhs == rhs);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	// binary arithmetic operators.
+
+	template <typename _T1, typename _T2, typename _O1, typename _O2>
+	inline dynamic_matrix<typename std::common_type<_T1, _T2>::type, _O1> operator + (dynamic_matrix<_T1, _O1> const& lhs, dynamic_matrix<_T2, _O2> const& rhs) {
+		typedef typename std::common_type<_T1, _T2>::type common_t;
+		return dynamic_matrix<common_t, _O1>(lhs) += dynamic_matrix<common_t, _O1>(rhs);
+	}
+
+	template <typename _T1, typename _T2, typename _O1, typename _O2>
+	inline dynamic_matrix<typename std::common_type<_T1, _T2>::type, _O1> operator - (dynamic_matrix<_T1, _O1> const& lhs, dynamic_matrix<_T2, _O2> const& rhs) {
+		typedef typename std::common_type<_T1, _T2>::type common_t;
+		return dynamic_matrix<common_t, _O1>(lhs) -= dynamic_matrix<common_t, _O1>(rhs);
+	}
+
+	template <typename _T1, typename _T2, typename _Order>
+	inline dynamic_matrix<typename std::common_type<_T1, _T2>::type, _Order> operator * (dynamic_matrix<_T1, _Order> const& mat, _T2 scalar) {
+		typedef typename std::common_type<_T1, _T2>::type common_t;
+		return dynamic_matrix<common_t, _Order>(mat) *= scalar;
+	}
+
+	template <typename _T1, typename _T2, typename _Order>
+	inline dynamic_matrix<typename std::common_type<_T1, _T2>::type, _Order> operator * (_T1 scalar, dynamic_matrix<_T2, _Order> const& mat) {
+		typedef typename std::common_type<_T1, _T2>::type common_t;
+		return dynamic_matrix<common_t, _Order>(mat) *= scalar;
+	}
+
+	template <typename _T1, typename _T2, typename _Order>
+	inline dynamic_matrix<typename std::common_type<_T1, _T2>::type, _Order> operator / (dynamic_matrix<_T1, _Order> const& mat, _T2 scalar) {
+		typedef typename std::common_type<_T1, _T2>::type common_t;
+		return dynamic_matrix<common_t, _Order>(mat) /= scalar;
+	}
+
+	template <typename _T1, typename _T2, typename _O1, typename _O2>
+	inline dynamic_matrix<typename std::common_type<_T1, _T2>::type, _O1> operator * (dynamic_matrix<_T1, _O1> const& lhs, dynamic_matrix<_T2, _O2> const& rhs) {
+		return multiply(lhs, rhs);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// precompiled instantiations (see math.cpp); multiply carries the blocked
+// gemm kernels with it.
+
+#define _MATH_DYNAMIC_MATRIX_INSTANTIATIONS(_Extern, _T) \
+	_Extern template struct dynamic_matrix<_T>; \
+	_Extern template dynamic_matrix<_T> multiply(dynamic_matrix<_T> const&, dynamic_matrix<_T> const&, unsigned);
+
+#if defined(MATH_EXTERN_TEMPLATES)
+namespace math {
+	_MATH_DYNAMIC_MATRIX_INSTANTIATIONS(extern, float)
+	_MATH_DYNAMIC_MATRIX_INSTANTIATIONS(extern, double)
+}
+#endif
+
+#endif // _MATH_DYNAMIC_MATRIX_HPP
@@ -0,0 +1,433 @@
+#ifndef _MATH_FIXED_HPP
+#define _MATH_FIXED_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <limits>
+#include <type_traits>
+
+#include "angle.hpp"
+#include "vector.hpp"
+#include "matrix.hpp"
+
+namespace math {
+
+	namespace internal {
+
+		////////////////////////////////////////////////////////////////////////////////
+		// widened representation used for products and quotients.
+
+		template <typename _Rep> struct fixed_rep {};
+
+		template <>
+		struct fixed_rep<std::int32_t> {
+			typedef std::int64_t wide_type;
+			typedef std::uint64_t unsigned_wide_type;
+		};
+
+#if defined(__SIZEOF_INT128__)
+		template <>
+		struct fixed_rep<std::int64_t> {
+			__extension__ typedef __int128 wide_type;
+			__extension__ typedef unsigned __int128 unsigned_wide_type;
+		};
+#endif
+
+		/// floor(sqrt(value)), bit by bit.
+		template <typename _Unsigned>
+		constexpr _Unsigned fixed_isqrt(_Unsigned value) noexcept {
+			_Unsigned result = 0;
+			_Unsigned bit = _Unsigned(1) << (sizeof(_Unsigned) * 8 - 2);
+			while (bit > value) bit >>= 2;
+			while (bit != 0) {
+				if (value >= result + bit) {
+					value -= result + bit;
+					result = (result >> 1) + bit;
+				}
+				else {
+					result >>= 1;
+				}
+				bit >>= 2;
+			}
+			return result;
+		}
+
+		/// quarter-wave sine table in Q2.30, 1024 segments. generated with integer
+		/// arithmetic only so every compiler produces the same bits.
+		struct fixed_sine_table {
+			static constexpr std::size_t segment_bits = 10;
+			static constexpr std::size_t size = (std::size_t(1) << segment_bits) + 1;
+			std::int32_t values[size] {};
+
+			constexpr fixed_sine_table() noexcept {
+				// pi/2 in Q2.61.
+				std::int64_t const half_pi = 7244019458077122842 / 2;
+				for (std::size_t i = 0; i < size; ++i) {
+					std::int64_t const x = ((half_pi >> segment_bits) * static_cast<std::int64_t>(i)) >> 31;
+					std::int64_t const x2 = (x * x) >> 30;
+					std::int64_t term = x, sum = x;
+					for (std::int64_t n = 1; n < 12; ++n) {
+						term = ((term * x2) >> 30) / ((2 * n) * (2 * n + 1));
+						sum += (n & 1) ? -term : term;
+					}
+					values[i] = static_cast<std::int32_t>(sum);
+				}
+			}
+		};
+
+		template <typename _Dummy = void>
+		struct fixed_sine {
+			static constexpr fixed_sine_table table {};
+		};
+
+		template <typename _Dummy>
+		constexpr fixed_sine_table fixed_sine<_Dummy>::table;
+
+		/// sin of phase / 2^32 turns, in Q2.30.
+		inline std::int32_t fixed_sin_phase(std::uint32_t phase) noexcept {
+			typedef fixed_sine_table table_t;
+			std::uint32_t const quadrant = phase >> 30;
+			std::uint32_t position = phase & ((std::uint32_t(1) << 30) - 1);
+			if (quadrant & 1) position = (std::uint32_t(1) << 30) - position;
+
+			std::size_t const shift = 30 - table_t::segment_bits;
+			std::size_t const index = position >> shift;
+			std::int64_t const fraction = position & ((std::uint32_t(1) << shift) - 1);
+
+			std::int32_t const* values = fixed_sine<>::table.values;
+			std::int64_t const lo = values[index];
+			std::int64_t const hi = index + 1 < table_t::size ? values[index + 1] : lo;
+			std::int32_t const value = static_cast<std::int32_t>(lo + (((hi - lo) * fraction) >> shift));
+			return quadrant & 2 ? -value : value;
+		}
+	}
+
+	/// signed fixed-point number with _FracBits fractional bits.
+	/// every operation is integer arithmetic, so results are bit-identical on
+	/// all platforms. products and quotients are formed in a type twice as wide
+	/// as _Rep and rounded once; results that do not fit in _Rep wrap. dividing
+	/// by zero is undefined, as it is for the underlying integers.
+	template <typename _Rep, std::size_t _FracBits>
+	struct basic_fixed {
+		static_assert(std::is_integral<_Rep>::value && std::is_signed<_Rep>::value,
+			"basic_fixed<Rep, F> requires signed integral type.");
+		static_assert(_FracBits > 0 && _FracBits < sizeof(_Rep) * 8 - 1,
+			"basic_fixed<Rep, F> requires 0 < F < bits(Rep) - 1.");
+
+		//////////////////////////////////////////////////////////////////////////////
+		// type definitions.
+
+		typedef _Rep rep_type;
+		typedef typename std::make_unsigned<_Rep>::type unsigned_rep_type;
+		typedef typename internal::fixed_rep<_Rep>::wide_type wide_type;
+		typedef typename internal::fixed_rep<_Rep>::unsigned_wide_type unsigned_wide_type;
+
+		static constexpr std::size_t fraction_bits = _FracBits;
+
+		//////////////////////////////////////////////////////////////////////////////
+		// construction.
+
+		constexpr basic_fixed() noexcept = default;
+
+		/// integers outside the representable range wrap. the shift is done on
+		/// the unsigned representation, where it is always defined.
+		template <typename _T, typename std::enable_if<std::is_integral<_T>::value, int>::type = 0>
+		constexpr basic_fixed(_T value) noexcept
+			: _raw(static_cast<_Rep>(static_cast<unsigned_rep_type>(value) << _FracBits)) {}
+
+		/// rounds to nearest. unlike integers, floating point values outside
+		/// the representable range saturate, and nan becomes zero.
+		template <typename _T, typename std::enable_if<std::is_floating_point<_T>::value, int>::type = 0>
+		constexpr basic_fixed(_T value) noexcept
+			: _raw(_saturate(value * static_cast<_T>(_one()) + (value < _T(0) ? _T(-0.5) : _T(0.5)))) {}
+
+		static constexpr basic_fixed from_raw(_Rep raw) noexcept {
+			basic_fixed result;
+			result._raw = raw;
+			return result;
+		}
+
+		//////////////////////////////////////////////////////////////////////////////
+		// accessor methods.
+
+		constexpr _Rep raw() const noexcept {
+			return _raw;
+		}
+
+		//////////////////////////////////////////////////////////////////////////////
+		// conversion operators.
+
+		template <typename _T, typename std::enable_if<std::is_floating_point<_T>::value, int>::type = 0>
+		constexpr explicit operator _T() const noexcept {
+			return static_cast<_T>(_raw) / static_cast<_T>(_one());
+		}
+
+		template <typename _T, typename std::enable_if<std::is_integral<_T>::value, int>::type = 0>
+		constexpr explicit operator _T() const noexcept {
+			return static_cast<_T>(_raw / _one());
+		}
+
+		//////////////////////////////////////////////////////////////////////////////
+		// unary arithmetic operators.
+
+		constexpr basic_fixed operator +() const noexcept {
+			return *this;
+		}
+
+		constexpr basic_fixed operator -() const noexcept {
+			return from_raw(static_cast<_Rep>(unsigned_rep_type(0) - static_cast<unsigned_rep_type>(_raw)));
+		}
+
+		//////////////////////////////////////////////////////////////////////////////
+		// compound arithmetic operators.
+
+		constexpr basic_fixed& operator += (basic_fixed const& other) noexcept {
+			_raw = static_cast<_Rep>(static_cast<unsigned_rep_type>(_raw) + static_cast<unsigned_rep_type>(other._raw));
+			return *this;
+		}
+
+		constexpr basic_fixed& operator -= (basic_fixed const& other) noexcept {
+			_raw = static_cast<_Rep>(static_cast<unsigned_rep_type>(_raw) - static_cast<unsigned_rep_type>(other._raw));
+			return *this;
+		}
+
+		constexpr basic_fixed& operator *= (basic_fixed const& other) noexcept {
+			_raw = narrow(static_cast<unsigned_wide_type>(static_cast<wide_type>(_raw) * other._raw));
+			return *this;
+		}
+
+		/// rounds to nearest, ties away from zero. other must not be zero.
+		constexpr basic_fixed& operator /= (basic_fixed const& other) noexcept {
+			wide_type const numerator = static_cast<wide_type>(_raw) * _one();
+			wide_type const divisor = other._raw;
+			wide_type const half = (divisor < 0 ? -divisor : divisor) / 2;
+			_raw = static_cast<_Rep>((numerator + (numerator < 0 ? -half : half)) / divisor);
+			return *this;
+		}
+
+		//////////////////////////////////////////////////////////////////////////////
+		// binary arithmetic operators.
+
+		friend constexpr basic_fixed operator + (basic_fixed lhs, basic_fixed const& rhs) noexcept { return lhs += rhs; }
+		friend constexpr basic_fixed operator - (basic_fixed lhs, basic_fixed const& rhs) noexcept { return lhs -= rhs; }
+		friend constexpr basic_fixed operator * (basic_fixed lhs, basic_fixed const& rhs) noexcept { return lhs *= rhs; }
+		friend constexpr basic_fixed operator / (basic_fixed lhs, basic_fixed const& rhs) noexcept { return lhs /= rhs; }
+
+		//////////////////////////////////////////////////////////////////////////////
+		// comparison operators.
+
+		friend constexpr bool operator == (basic_fixed const& lhs, basic_fixed const& rhs) noexcept { return lhs._raw == rhs._raw; }
+		friend constexpr bool operator != (basic_fixed const& lhs, basic_fixed const& rhs) noexcept { return lhs._raw != rhs._raw; }
+		friend constexpr bool operator < (basic_fixed const& lhs, basic_fixed const& rhs) noexcept { return lhs._raw < rhs._raw; }
+		friend constexpr bool operator > (basic_fixed const& lhs, basic_fixed const& rhs) noexcept { return lhs._raw > rhs._raw; }
+		friend constexpr bool operator <= (basic_fixed const& lhs, basic_fixed const& rhs) noexcept { return lhs._raw <= rhs._raw; }
+		friend constexpr bool operator >= (basic_fixed const& lhs, basic_fixed const& rhs) noexcept { return lhs._raw >= rhs._raw; }
+
+		//////////////////////////////////////////////////////////////////////////////
+		// streaming operators.
+
+		template <typename _CharT, typename _OsTraits>
+		friend std::basic_ostream<_CharT, _OsTraits>& operator << (std::basic_ostream<_CharT, _OsTraits>& ostr, basic_fixed const& value) {
+			return ostr << static_cast<double>(value);
+		}
+
+		//////////////////////////////////////////////////////////////////////////////
+		// helpers.
+
+		/// rounds a product of two raw values, or a sum of them (2 * _FracBits
+		/// fractional bits), back to _FracBits. sums are kept unsigned so they
+		/// wrap; the bits that survive narrowing are the same as for an
+		/// arithmetic shift of the signed value.
+		static constexpr _Rep narrow(unsigned_wide_type product) noexcept {
+			return static_cast<_Rep>(static_cast<unsigned_rep_type>((product + (unsigned_wide_type(1) << (_FracBits - 1))) >> _FracBits));
+		}
+
+	private:
+		_Rep _raw = 0;
+
+		static constexpr _Rep _one() noexcept {
+			return _Rep(1) << _FracBits;
+		}
+
+		/// truncates scaled to _Rep, clamped to its range. -min is a power of
+		/// two, so it converts to _T exactly.
+		template <typename _T>
+		static constexpr _Rep _saturate(_T scaled) noexcept {
+			return scaled != scaled ? _Rep(0)
+				: scaled >= -static_cast<_T>(std::numeric_limits<_Rep>::min()) ? std::numeric_limits<_Rep>::max()
+				: scaled <= static_cast<_T>(std::numeric_limits<_Rep>::min()) ? std::numeric_limits<_Rep>::min()
+				: static_cast<_Rep>(scaled);
+		}
+	};
+
+	template <typename _Rep, std::size_t _FracBits>
+	constexpr std::size_t basic_fixed<_Rep, _FracBits>::fraction_bits;
+
+	typedef basic_fixed<std::int32_t, 16> fixed16_16;
+#if defined(__SIZEOF_INT128__)
+	typedef basic_fixed<std::int64_t, 32> fixed32_32;
+#endif
+
+	template <typename _Rep, std::size_t _FracBits>
+	struct is_arithmetic<basic_fixed<_Rep, _FracBits>> : std::true_type {};
+
+	//////////////////////////////////////////////////////////////////////////////
+	// angle traits.
+
+	template <typename _Rep, std::size_t _FracBits>
+	struct radian_traits<basic_fixed<_Rep, _FracBits>> {
+		static constexpr basic_fixed<_Rep, _FracBits> pi() noexcept {
+			// pi in Q2.61, rounded to _FracBits.
+			return basic_fixed<_Rep, _FracBits>::from_raw(static_cast<_Rep>(
+				((7244019458077122842 >> (60 - _FracBits)) + 1) >> 1));
+		}
+	};
+
+	template <typename _Rep, std::size_t _FracBits>
+	struct revolution_traits<basic_fixed<_Rep, _FracBits>> {
+		static constexpr basic_fixed<_Rep, _FracBits> pi() noexcept {
+			return basic_fixed<_Rep, _FracBits>::from_raw(_Rep(1) << (_FracBits - 1));
+		}
+	};
+
+	//////////////////////////////////////////////////////////////////////////////
+	// functions.
+
+	template <typename _Rep, std::size_t _FracBits>
+	constexpr basic_fixed<_Rep, _FracBits> abs(basic_fixed<_Rep, _FracBits> const& x) noexcept {
+		return x.raw() < 0 ? -x : x;
+	}
+
+	/// integer square root, exact to the last fractional bit (rounded down).
+	template <typename _Rep, std::size_t _FracBits>
+	constexpr basic_fixed<_Rep, _FracBits> sqrt(basic_fixed<_Rep, _FracBits> const& x) noexcept {
+		typedef typename basic_fixed<_Rep, _FracBits>::unsigned_wide_type unsigned_wide_t;
+		if (x.raw() <= 0) return basic_fixed<_Rep, _FracBits>();
+		return basic_fixed<_Rep, _FracBits>::from_raw(static_cast<_Rep>(
+			internal::fixed_isqrt(static_cast<unsigned_wide_t>(x.raw()) << _FracBits)));
+	}
+
+	namespace internal {
+
+		/// converts a Q2.30 value to _FracBits fractional bits.
+		template <typename _Rep, std::size_t _FracBits>
+		constexpr _Rep fixed_from_q30(std::int32_t value, std::true_type) noexcept {
+			return static_cast<_Rep>((static_cast<std::int64_t>(value) + (std::int64_t(1) << (29 - _FracBits))) >> (30 - _FracBits));
+		}
+
+		template <typename _Rep, std::size_t _FracBits>
+		constexpr _Rep fixed_from_q30(std::int32_t value, std::false_type) noexcept {
+			return static_cast<_Rep>(static_cast<_Rep>(value) * (_Rep(1) << (_FracBits - 30)));
+		}
+
+		template <typename _Rep, std::size_t _FracBits, typename _Traits>
+		basic_fixed<_Rep, _FracBits> fixed_sincos(basic_angle<basic_fixed<_Rep, _FracBits>, _Traits> const& x, std::uint32_t offset) noexcept {
+			typedef basic_fixed<_Rep, _FracBits> fixed_t;
+			typedef typename fixed_t::wide_type wide_t;
+
+			// angle as a fraction of a turn in Q0.32; the half turn is _Traits::pi().
+			wide_t const half_turn = _Traits::pi().raw();
+			std::uint32_t const phase = static_cast<std::uint32_t>(
+				static_cast<wide_t>(x.value().raw()) * (wide_t(1) << 31) / half_turn) + offset;
+
+			return fixed_t::from_raw(fixed_from_q30<_Rep, _FracBits>(fixed_sin_phase(phase),
+				std::integral_constant<bool, (_FracBits < 30)>()));
+		}
+	}
+
+	/// table sin/cos with linear interpolation. the table itself is good to
+	/// 3e-7; narrower formats are limited by the rounding of pi and of the
+	/// result to _FracBits.
+	template <typename _Rep, std::size_t _FracBits, typename _Traits>
+	basic_fixed<_Rep, _FracBits> sin(basic_angle<basic_fixed<_Rep, _FracBits>, _Traits> const& x) noexcept {
+		return internal::fixed_sincos(x, 0);
+	}
+
+	template <typename _Rep, std::size_t _FracBits, typename _Traits>
+	basic_fixed<_Rep, _FracBits> cos(basic_angle<basic_fixed<_Rep, _FracBits>, _Traits> const& x) noexcept {
+		return internal::fixed_sincos(x, std::uint32_t(1) << 30);
+	}
+
+	template <typename _Rep, std::size_t _FracBits, typename _Traits>
+	basic_fixed<_Rep, _FracBits> tan(basic_angle<basic_fixed<_Rep, _FracBits>, _Traits> const& x) noexcept {
+		return sin(x) / cos(x);
+	}
+
+	namespace internal {
+
+		/// widened product of two raw values, as the unsigned wide type so that
+		/// sums of products wrap instead of overflowing.
+		template <typename _Fixed>
+		constexpr typename _Fixed::unsigned_wide_type fixed_product(typename _Fixed::rep_type lhs, typename _Fixed::rep_type rhs) noexcept {
+			return static_cast<typename _Fixed::unsigned_wide_type>(static_cast<typename _Fixed::wide_type>(lhs) * rhs);
+		}
+	}
+
+	/// dot product accumulated at double width and rounded once.
+	template <typename _Rep, std::size_t _FracBits, std::size_t _N>
+	constexpr basic_fixed<_Rep, _FracBits> dot_product(
+		vector<basic_fixed<_Rep, _FracBits>, _N> const& lhs,
+		vector<basic_fixed<_Rep, _FracBits>, _N> const& rhs) noexcept {
+			typedef basic_fixed<_Rep, _FracBits> fixed_t;
+			typename fixed_t::unsigned_wide_type sum = 0;
+			for (std::size_t i = 0; i < _N; ++i)
+				sum += internal::fixed_product<fixed_t>(lhs[i].raw(), rhs[i].raw());
+			return fixed_t::from_raw(fixed_t::narrow(sum));
+		}
+
+	////////////////////////////////////////////////////////////////////////////////
+	// batch kernels.
+	// these give the same bits as the scalar operators, in plain loops over
+	// the raw integers. they stay scalar on purpose: x86-64 before sse4.1 has
+	// no signed 32 x 32 -> 64 bit lane multiply, and a lane-wise version built
+	// from unsigned multiplies and sign corrections ran at less than half the
+	// speed of these loops, even with avx2, once the array-of-structures
+	// inputs are transposed into lanes.
+
+	/// out[i] = dot_product(a[i], b[i]).
+	template <typename _Rep, std::size_t _FracBits, std::size_t _N>
+	void dot_products(
+		vector<basic_fixed<_Rep, _FracBits>, _N> const* a,
+		vector<basic_fixed<_Rep, _FracBits>, _N> const* b,
+		std::size_t count, basic_fixed<_Rep, _FracBits>* out) noexcept {
+			typedef basic_fixed<_Rep, _FracBits> fixed_t;
+			for (std::size_t i = 0; i < count; ++i) {
+				typename fixed_t::unsigned_wide_type sum = 0;
+				for (std::size_t d = 0; d < _N; ++d)
+					sum += internal::fixed_product<fixed_t>(a[i][d].raw(), b[i][d].raw());
+				out[i] = fixed_t::from_raw(fixed_t::narrow(sum));
+			}
+		}
+
+	/// out[i] = m * (points[i], 1), dropping the w component. each output
+	/// component is accumulated at double width and rounded once, so results
+	/// can differ in the last bit from composing the scalar operators.
+	template <typename _Rep, std::size_t _FracBits, typename _Order>
+	void transform_points(
+		matrix<basic_fixed<_Rep, _FracBits>, 4, 4, _Order> const& m,
+		vector3<basic_fixed<_Rep, _FracBits>> const* points,
+		std::size_t count, vector3<basic_fixed<_Rep, _FracBits>>* out) noexcept {
+			typedef basic_fixed<_Rep, _FracBits> fixed_t;
+			typedef typename fixed_t::unsigned_wide_type unsigned_wide_t;
+
+			// the translation is already in 2 * _FracBits fractional bits.
+			_Rep coefficients[3][3];
+			unsigned_wide_t translation[3];
+			for (std::size_t r = 0; r < 3; ++r) {
+				for (std::size_t c = 0; c < 3; ++c) coefficients[r][c] = m(r, c).raw();
+				translation[r] = static_cast<unsigned_wide_t>(m(r, 3).raw()) << _FracBits;
+			}
+
+			for (std::size_t i = 0; i < count; ++i) {
+				_Rep const x = points[i].x.raw(), y = points[i].y.raw(), z = points[i].z.raw();
+				for (std::size_t r = 0; r < 3; ++r) {
+					unsigned_wide_t const sum = translation[r] + internal::fixed_product<fixed_t>(coefficients[r][0], x)
+						+ internal::fixed_product<fixed_t>(coefficients[r][1], y) + internal::fixed_product<fixed_t>(coefficients[r][2], z);
+					out[i][r] = fixed_t::from_raw(fixed_t::narrow(sum));
+				}
+			}
+		}
+}
+
+#endif // _MATH_FIXED_HPP
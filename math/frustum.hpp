@@ -0,0 +1,308 @@
+#ifndef _MATH_FRUSTUM_HPP
+#define _MATH_FRUSTUM_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <type_traits>
+
+#include "vector.hpp"
+#include "matrix.hpp"
+
+namespace math {
+
+	/// the plane dot(normal, p) + distance = 0, stored as the vector4
+	/// (normal, distance). the side the normal points to is positive.
+	template <typename _T>
+	struct plane {
+		static_assert(std::is_floating_point<_T>::value,
+			"plane<T> requires floating point type.");
+
+		typedef _T value_type;
+
+		////////////////////////////////////////////////////////////////////////////////
+		// constructors.
+
+		constexpr plane() = default;
+
+		constexpr explicit plane(vector4<_T> const& coefficients) noexcept
+			: _coefficients(coefficients) {}
+
+		constexpr plane(vector3<_T> const& normal, _T distance) noexcept
+			: _coefficients(normal.x, normal.y, normal.z, distance) {}
+
+		/// the plane through point with the given normal.
+		static constexpr plane through(vector3<_T> const& point, vector3<_T> const& normal) noexcept {
+			return plane(normal, -(normal.x * point.x + normal.y * point.y + normal.z * point.z));
+		}
+
+		////////////////////////////////////////////////////////////////////////////////
+		// accessor methods.
+
+		constexpr vector4<_T> const& coefficients() const noexcept { return _coefficients; }
+		constexpr vector3<_T> normal() const noexcept { return vector3<_T> { _coefficients.x, _coefficients.y, _coefficients.z }; }
+		constexpr _T distance() const noexcept { return _coefficients.w; }
+
+		/// signed distance of point, in units of the normal's length.
+		constexpr _T signed_distance(vector3<_T> const& point) const noexcept {
+			return _coefficients.x * point.x + _coefficients.y * point.y + _coefficients.z * point.z + _coefficients.w;
+		}
+
+		/// the same plane with a unit normal, so signed_distance() is euclidean.
+		plane normalized() const noexcept {
+			_T const length = normal().length();
+			return length > _T(0) ? plane(_coefficients / length) : *this;
+		}
+
+	private:
+		vector4<_T> _coefficients { _T(0), _T(0), _T(0), _T(0) };
+	};
+
+	/// clip-space depth range of the projection a frustum is extracted from.
+	enum class clip_depth {
+		negative_one_to_one,	// opengl.
+		zero_to_one				// direct3d, vulkan, metal.
+	};
+
+	/// six inward-facing planes with unit normals; a point is inside when its
+	/// signed distance to every plane is non-negative.
+	template <typename _T>
+	struct frustum {
+		typedef _T value_type;
+		typedef plane<_T> plane_type;
+		typedef std::size_t size_type;
+
+		enum side { left_plane, right_plane, bottom_plane, top_plane, near_plane, far_plane };
+
+		static constexpr size_type plane_count = 6;
+
+		////////////////////////////////////////////////////////////////////////////////
+		// constructors.
+
+		frustum() = default;
+
+		/// extracts the planes of the view volume of a (projection * view)
+		/// matrix that maps column vectors to clip space (gribb & hartmann).
+		template <typename _T2, typename _Order>
+		explicit frustum(matrix<_T2, 4, 4, _Order> const& m, clip_depth depth = clip_depth::negative_one_to_one) noexcept {
+			vector4<_T> row[4];
+			for (size_type r = 0; r < 4; ++r)
+				row[r] = vector4<_T> { static_cast<_T>(m(r, 0)), static_cast<_T>(m(r, 1)), static_cast<_T>(m(r, 2)), static_cast<_T>(m(r, 3)) };
+
+			_planes[left_plane] = plane_type(row[3] + row[0]).normalized();
+			_planes[right_plane] = plane_type(row[3] - row[0]).normalized();
+			_planes[bottom_plane] = plane_type(row[3] + row[1]).normalized();
+			_planes[top_plane] = plane_type(row[3] - row[1]).normalized();
+			_planes[near_plane] = plane_type(depth == clip_depth::zero_to_one ? row[2] : row[3] + row[2]).normalized();
+			_planes[far_plane] = plane_type(row[3] - row[2]).normalized();
+		}
+
+		////////////////////////////////////////////////////////////////////////////////
+		// accessor methods.
+
+		plane_type& operator [](size_type index) noexcept { return _planes[index]; }
+		plane_type const& operator [](size_type index) const noexcept { return _planes[index]; }
+
+		plane_type const* begin() const noexcept { return _planes; }
+		plane_type const* end() const noexcept { return _planes + plane_count; }
+
+		////////////////////////////////////////////////////////////////////////////////
+		// single tests.
+		// conservative: a volume that straddles two planes outside a corner of
+		// the frustum is reported as intersecting.
+
+		bool contains(vector3<_T> const& point) const noexcept {
+			for (auto const& p : _planes)
+				if (p.signed_distance(point) < _T(0)) return false;
+			return true;
+		}
+
+		bool intersects_sphere(vector3<_T> const& center, _T radius) const noexcept {
+			for (auto const& p : _planes)
+				if (p.signed_distance(center) < -radius) return false;
+			return true;
+		}
+
+		bool intersects_box(vector3<_T> const& center, vector3<_T> const& extent) const noexcept {
+			for (auto const& p : _planes) {
+				vector4<_T> const& c = p.coefficients();
+				_T const reach = std::abs(c.x) * extent.x + std::abs(c.y) * extent.y + std::abs(c.z) * extent.z;
+				if (p.signed_distance(center) < -reach) return false;
+			}
+			return true;
+		}
+
+	private:
+		plane_type _planes[plane_count];
+	};
+
+	template <typename _T>
+	constexpr typename frustum<_T>::size_type frustum<_T>::plane_count;
+
+	////////////////////////////////////////////////////////////////////////////////
+	// batch culling.
+	// volumes are given as separate arrays per component. they are tested 64
+	// at a time, one plane after another, as straight-line loops the compiler
+	// vectorizes; a block stops being tested as soon as every volume in it is
+	// outside some plane. results are either a bitmask, bit i % 64 of word
+	// i / 64 set when volume i is visible (bits past count are cleared), or the
+	// indices of the visible volumes in increasing order.
+
+	/// spheres: center (x, y, z) and radius.
+	template <typename _T>
+	struct sphere_batch {
+		_T const* x;
+		_T const* y;
+		_T const* z;
+		_T const* radius;
+		std::size_t count;
+	};
+
+	/// axis-aligned boxes: center (x, y, z) and half extents.
+	template <typename _T>
+	struct box_batch {
+		_T const* x;
+		_T const* y;
+		_T const* z;
+		_T const* extent_x;
+		_T const* extent_y;
+		_T const* extent_z;
+		std::size_t count;
+	};
+
+	namespace internal {
+
+		constexpr std::size_t cull_block = 64;
+
+		inline unsigned count_trailing_zeros(std::uint64_t word) noexcept {
+#if defined(__GNUC__)
+			return static_cast<unsigned>(__builtin_ctzll(word));
+#else
+			unsigned result = 0;
+			for (; !(word & 1); word >>= 1) ++result;
+			return result;
+#endif
+		}
+
+		/// copies n < cull_block values to tail, zero padded to a whole block.
+		template <typename _T>
+		_T const* cull_pad(_T const* values, std::size_t n, _T* tail) noexcept {
+			for (std::size_t i = 0; i < cull_block; ++i) tail[i] = i < n ? values[i] : _T(0);
+			return tail;
+		}
+
+		/// the block of cull_block volumes starting at first; a short final block
+		/// is copied into tail.
+		template <typename _T>
+		sphere_batch<_T> cull_slice(sphere_batch<_T> const& s, std::size_t first, std::size_t n, _T (*tail)[cull_block]) noexcept {
+			if (n == cull_block) return sphere_batch<_T> { s.x + first, s.y + first, s.z + first, s.radius + first, n };
+			return sphere_batch<_T> {
+				cull_pad(s.x + first, n, tail[0]), cull_pad(s.y + first, n, tail[1]),
+				cull_pad(s.z + first, n, tail[2]), cull_pad(s.radius + first, n, tail[3]), n };
+		}
+
+		template <typename _T>
+		box_batch<_T> cull_slice(box_batch<_T> const& b, std::size_t first, std::size_t n, _T (*tail)[cull_block]) noexcept {
+			if (n == cull_block) return box_batch<_T> { b.x + first, b.y + first, b.z + first, b.extent_x + first, b.extent_y + first, b.extent_z + first, n };
+			return box_batch<_T> {
+				cull_pad(b.x + first, n, tail[0]), cull_pad(b.y + first, n, tail[1]), cull_pad(b.z + first, n, tail[2]),
+				cull_pad(b.extent_x + first, n, tail[3]), cull_pad(b.extent_y + first, n, tail[4]), cull_pad(b.extent_z + first, n, tail[5]), n };
+		}
+
+		/// the visibility word of one whole block. every loop runs exactly
+		/// cull_block times, which lets the compiler vectorize them without a
+		/// scalar remainder.
+		template <typename _T>
+		std::uint64_t cull_block_mask(frustum<_T> const& f, sphere_batch<_T> const& s) noexcept {
+			unsigned char inside[cull_block];
+			for (std::size_t i = 0; i < cull_block; ++i) inside[i] = 1;
+
+			for (auto const& p : f) {
+				vector4<_T> const c = p.coefficients();
+				unsigned char any = 0;
+				for (std::size_t i = 0; i < cull_block; ++i) {
+					_T const d = c.x * s.x[i] + c.y * s.y[i] + c.z * s.z[i] + c.w;
+					inside[i] &= static_cast<unsigned char>(d >= -s.radius[i]);
+					any |= inside[i];
+				}
+				if (!any) return 0;
+			}
+
+			std::uint64_t word = 0;
+			for (std::size_t i = 0; i < cull_block; ++i) word |= std::uint64_t(inside[i]) << i;
+			return word;
+		}
+
+		template <typename _T>
+		std::uint64_t cull_block_mask(frustum<_T> const& f, box_batch<_T> const& b) noexcept {
+			unsigned char inside[cull_block];
+			for (std::size_t i = 0; i < cull_block; ++i) inside[i] = 1;
+
+			for (auto const& p : f) {
+				vector4<_T> const c = p.coefficients();
+				_T const ax = std::abs(c.x), ay = std::abs(c.y), az = std::abs(c.z);
+				unsigned char any = 0;
+				for (std::size_t i = 0; i < cull_block; ++i) {
+					_T const d = c.x * b.x[i] + c.y * b.y[i] + c.z * b.z[i] + c.w;
+					_T const reach = ax * b.extent_x[i] + ay * b.extent_y[i] + az * b.extent_z[i];
+					inside[i] &= static_cast<unsigned char>(d >= -reach);
+					any |= inside[i];
+				}
+				if (!any) return 0;
+			}
+
+			std::uint64_t word = 0;
+			for (std::size_t i = 0; i < cull_block; ++i) word |= std::uint64_t(inside[i]) << i;
+			return word;
+		}
+
+		/// the visibility word of volumes [first, first + cull_block).
+		template <typename _T, typename _Batch>
+		std::uint64_t cull_word(frustum<_T> const& f, _Batch const& batch, std::size_t first) noexcept {
+			_T tail[6][cull_block];
+			std::size_t const n = std::min(cull_block, batch.count - first);
+			std::uint64_t const word = cull_block_mask(f, cull_slice(batch, first, n, tail));
+			return n == cull_block ? word : word & ((std::uint64_t(1) << n) - 1);
+		}
+
+		template <typename _T, typename _Batch>
+		void cull_mask(frustum<_T> const& f, _Batch const& batch, std::uint64_t* mask) noexcept {
+			for (std::size_t first = 0; first < batch.count; first += cull_block)
+				*mask++ = cull_word(f, batch, first);
+		}
+
+		template <typename _T, typename _Batch, typename _OutputIt>
+		_OutputIt cull_indices(frustum<_T> const& f, _Batch const& batch, _OutputIt d_first) {
+			for (std::size_t first = 0; first < batch.count; first += cull_block) {
+				std::uint64_t word = cull_word(f, batch, first);
+				for (; word; word &= word - 1, ++d_first) *d_first = first + count_trailing_zeros(word);
+			}
+			return d_first;
+		}
+	}
+
+	/// writes (count + 63) / 64 words to mask.
+	template <typename _T>
+	void cull(frustum<_T> const& f, sphere_batch<_T> const& spheres, std::uint64_t* mask) noexcept {
+		internal::cull_mask(f, spheres, mask);
+	}
+
+	template <typename _T>
+	void cull(frustum<_T> const& f, box_batch<_T> const& boxes, std::uint64_t* mask) noexcept {
+		internal::cull_mask(f, boxes, mask);
+	}
+
+	/// writes the index of every visible sphere to d_first.
+	template <typename _T, typename _OutputIt>
+	_OutputIt visible(frustum<_T> const& f, sphere_batch<_T> const& spheres, _OutputIt d_first) {
+		return internal::cull_indices(f, spheres, d_first);
+	}
+
+	template <typename _T, typename _OutputIt>
+	_OutputIt visible(frustum<_T> const& f, box_batch<_T> const& boxes, _OutputIt d_first) {
+		return internal::cull_indices(f, boxes, d_first);
+	}
+}
+
+#endif // _MATH_FRUSTUM_HPP
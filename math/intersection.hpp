@@ -0,0 +1,305 @@
+#ifndef _MATH_INTERSECTION_HPP
+#define _MATH_INTERSECTION_HPP
+
+#include <cmath>
+#include <limits>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <type_traits>
+
+#include "vector.hpp"
+#include "memory.hpp"
+
+namespace math {
+
+	template <typename _T>
+	struct ray {
+		vector3<_T> origin;
+		vector3<_T> direction;
+	};
+
+	/// closest intersection along a ray: distance t (in units of the
+	/// direction's length), barycentric u and v, and the triangle index, or
+	/// ray_hit::none if nothing was hit.
+	template <typename _T>
+	struct ray_hit {
+		static constexpr std::uint32_t none = std::numeric_limits<std::uint32_t>::max();
+
+		_T t;
+		_T u, v;
+		std::uint32_t triangle;
+
+		constexpr explicit operator bool() const noexcept { return triangle != none; }
+	};
+
+	template <typename _T>
+	constexpr std::uint32_t ray_hit<_T>::none;
+
+	////////////////////////////////////////////////////////////////////////////////
+	// packets.
+	// _N rays stored one array per component, so the kernels below run the
+	// same arithmetic on every lane and the compiler vectorizes them over
+	// the rays. 4, 8 and 16 match sse, avx and avx-512 float registers.
+	// a packet holds the closest hit found so far for each lane; t_max
+	// doubles as the clipping distance for later tests.
+
+	template <typename _T, std::size_t _N>
+	struct alignas(buffer_alignment) ray_packet {
+		static_assert(std::is_floating_point<_T>::value,
+			"ray_packet<T, N> requires floating point type.");
+		static_assert(_N > 0 && _N <= 32,
+			"ray_packet<T, N> requires 1 to 32 rays.");
+
+		typedef _T value_type;
+		typedef std::size_t size_type;
+
+		static constexpr size_type size = _N;
+
+		_T origin_x[_N], origin_y[_N], origin_z[_N];
+		_T direction_x[_N], direction_y[_N], direction_z[_N];
+		_T inverse_x[_N], inverse_y[_N], inverse_z[_N];
+		_T t_max[_N];
+		_T u[_N], v[_N];
+		std::uint32_t triangle[_N];
+
+		/// every lane is a ray that hits nothing.
+		ray_packet() noexcept {
+			for (size_type i = 0; i < _N; ++i) set(i, ray<_T> { vector3<_T>(), vector3<_T> { _T(0), _T(0), _T(1) } }, _T(0));
+		}
+
+		void set(size_type lane, ray<_T> const& r, _T distance = std::numeric_limits<_T>::infinity()) noexcept {
+			origin_x[lane] = r.origin.x; origin_y[lane] = r.origin.y; origin_z[lane] = r.origin.z;
+			direction_x[lane] = r.direction.x; direction_y[lane] = r.direction.y; direction_z[lane] = r.direction.z;
+			inverse_x[lane] = _T(1) / r.direction.x;
+			inverse_y[lane] = _T(1) / r.direction.y;
+			inverse_z[lane] = _T(1) / r.direction.z;
+			t_max[lane] = distance;
+			u[lane] = v[lane] = _T(0);
+			triangle[lane] = ray_hit<_T>::none;
+		}
+
+		ray<_T> get(size_type lane) const noexcept {
+			return ray<_T> {
+				vector3<_T> { origin_x[lane], origin_y[lane], origin_z[lane] },
+				vector3<_T> { direction_x[lane], direction_y[lane], direction_z[lane] } };
+		}
+
+		ray_hit<_T> hit(size_type lane) const noexcept {
+			return ray_hit<_T> { t_max[lane], u[lane], v[lane], triangle[lane] };
+		}
+	};
+
+	template <typename _T, std::size_t _N>
+	constexpr typename ray_packet<_T, _N>::size_type ray_packet<_T, _N>::size;
+
+	////////////////////////////////////////////////////////////////////////////////
+	// triangle blocks.
+	// _W triangles per block as the first vertex and the two edges leaving it,
+	// one array per component. unused slots are degenerate and never hit.
+
+	template <typename _T, std::size_t _W = 8>
+	struct alignas(buffer_alignment) triangle_block {
+		static constexpr std::size_t width = _W;
+
+		_T origin_x[_W], origin_y[_W], origin_z[_W];
+		_T edge1_x[_W], edge1_y[_W], edge1_z[_W];
+		_T edge2_x[_W], edge2_y[_W], edge2_z[_W];
+		std::uint32_t index[_W];
+		std::size_t count;
+	};
+
+	template <typename _T, std::size_t _W>
+	constexpr std::size_t triangle_block<_T, _W>::width;
+
+	/// a triangle soup packed into triangle_blocks.
+	template <typename _T, std::size_t _W = 8>
+	struct triangle_blocks {
+		typedef triangle_block<_T, _W> block_type;
+		typedef typename aligned_vector<block_type>::const_iterator const_iterator;
+		typedef std::size_t size_type;
+
+		triangle_blocks() = default;
+
+		/// consecutive triples of vertices in [first, last) are triangles; one
+		/// or two vertices left over at the end are ignored.
+		template <typename _InputIt>
+		triangle_blocks(_InputIt first, _InputIt last) {
+			std::uint32_t index = 0;
+			while (first != last) {
+				vector3<_T> const a = *first;
+				if (++first == last) break;
+				vector3<_T> const b = *first;
+				if (++first == last) break;
+				vector3<_T> const c = *first;
+				++first;
+				add(a, b, c, index++);
+			}
+		}
+
+		/// consecutive triples of indices in [index_first, index_last) name the
+		/// vertices of a triangle in the random-access range at vertices; one or
+		/// two indices left over at the end are ignored.
+		template <typename _RandomIt, typename _InputIt>
+		triangle_blocks(_RandomIt vertices, _InputIt index_first, _InputIt index_last) {
+			std::uint32_t index = 0;
+			while (index_first != index_last) {
+				vector3<_T> const a = vertices[*index_first];
+				if (++index_first == index_last) break;
+				vector3<_T> const b = vertices[*index_first];
+				if (++index_first == index_last) break;
+				vector3<_T> const c = vertices[*index_first];
+				++index_first;
+				add(a, b, c, index++);
+			}
+		}
+
+		void add(vector3<_T> const& a, vector3<_T> const& b, vector3<_T> const& c, std::uint32_t index) {
+			if (_blocks.empty() || _blocks.back().count == _W) {
+				block_type block;
+				for (std::size_t i = 0; i < _W; ++i) {
+					block.origin_x[i] = block.origin_y[i] = block.origin_z[i] = _T(0);
+					block.edge1_x[i] = block.edge1_y[i] = block.edge1_z[i] = _T(0);
+					block.edge2_x[i] = block.edge2_y[i] = block.edge2_z[i] = _T(0);
+					block.index[i] = ray_hit<_T>::none;
+				}
+				block.count = 0;
+				_blocks.push_back(block);
+			}
+
+			block_type& block = _blocks.back();
+			std::size_t const i = block.count++;
+			block.origin_x[i] = a.x; block.origin_y[i] = a.y; block.origin_z[i] = a.z;
+			block.edge1_x[i] = b.x - a.x; block.edge1_y[i] = b.y - a.y; block.edge1_z[i] = b.z - a.z;
+			block.edge2_x[i] = c.x - a.x; block.edge2_y[i] = c.y - a.y; block.edge2_z[i] = c.z - a.z;
+			block.index[i] = index;
+			++_size;
+		}
+
+		size_type size() const noexcept { return _size; }
+		bool empty() const noexcept { return _size == 0; }
+
+		const_iterator begin() const noexcept { return _blocks.begin(); }
+		const_iterator end() const noexcept { return _blocks.end(); }
+
+	private:
+		aligned_vector<block_type> _blocks;
+		size_type _size = 0;
+	};
+
+	////////////////////////////////////////////////////////////////////////////////
+	// kernels.
+	// they only read their inputs and write the packet, so any number of
+	// threads may run them over shared triangles, each with its own packets.
+
+	/// moller-trumbore against every triangle of the block; lanes hit closer
+	/// than their t_max are updated. both faces count as hits.
+	template <typename _T, std::size_t _N, std::size_t _W>
+	void intersect(ray_packet<_T, _N>& packet, triangle_block<_T, _W> const& block) noexcept {
+		_T const epsilon = std::numeric_limits<_T>::epsilon();
+
+		for (std::size_t j = 0; j < block.count; ++j) {
+			_T const ox = block.origin_x[j], oy = block.origin_y[j], oz = block.origin_z[j];
+			_T const e1x = block.edge1_x[j], e1y = block.edge1_y[j], e1z = block.edge1_z[j];
+			_T const e2x = block.edge2_x[j], e2y = block.edge2_y[j], e2z = block.edge2_z[j];
+			std::uint32_t const index = block.index[j];
+
+			for (std::size_t i = 0; i < _N; ++i) {
+				_T const dx = packet.direction_x[i], dy = packet.direction_y[i], dz = packet.direction_z[i];
+
+				_T const px = dy * e2z - dz * e2y;
+				_T const py = dz * e2x - dx * e2z;
+				_T const pz = dx * e2y - dy * e2x;
+				_T const det = e1x * px + e1y * py + e1z * pz;
+				_T const inv = _T(1) / det;
+
+				_T const tx = packet.origin_x[i] - ox;
+				_T const ty = packet.origin_y[i] - oy;
+				_T const tz = packet.origin_z[i] - oz;
+				_T const u = (tx * px + ty * py + tz * pz) * inv;
+
+				_T const qx = ty * e1z - tz * e1y;
+				_T const qy = tz * e1x - tx * e1z;
+				_T const qz = tx * e1y - ty * e1x;
+				_T const v = (dx * qx + dy * qy + dz * qz) * inv;
+				_T const t = (e2x * qx + e2y * qy + e2z * qz) * inv;
+
+				// non-short-circuit so the lane loop stays branch-free.
+				bool const hit = (std::abs(det) > epsilon) & (u >= _T(0)) & (v >= _T(0)) & (u + v <= _T(1))
+					& (t > _T(0)) & (t < packet.t_max[i]);
+
+				packet.t_max[i] = hit ? t : packet.t_max[i];
+				packet.u[i] = hit ? u : packet.u[i];
+				packet.v[i] = hit ? v : packet.v[i];
+				// an integer select on a floating point condition is not
+				// vectorized; masking is.
+				packet.triangle[i] ^= (packet.triangle[i] ^ index) & (0u - std::uint32_t(hit));
+			}
+		}
+	}
+
+	/// slab test of every lane against the box [low, high]; bit i of the
+	/// result is set when lane i enters the box before its t_max. entry
+	/// distances are written to t_enter when given.
+	template <typename _T, std::size_t _N>
+	std::uint32_t intersect(ray_packet<_T, _N> const& packet, vector3<_T> const& low, vector3<_T> const& high, _T* t_enter = nullptr) noexcept {
+		std::uint32_t mask = 0;
+		for (std::size_t i = 0; i < _N; ++i) {
+			_T const x0 = (low.x - packet.origin_x[i]) * packet.inverse_x[i];
+			_T const x1 = (high.x - packet.origin_x[i]) * packet.inverse_x[i];
+			_T const y0 = (low.y - packet.origin_y[i]) * packet.inverse_y[i];
+			_T const y1 = (high.y - packet.origin_y[i]) * packet.inverse_y[i];
+			_T const z0 = (low.z - packet.origin_z[i]) * packet.inverse_z[i];
+			_T const z1 = (high.z - packet.origin_z[i]) * packet.inverse_z[i];
+
+			_T const entry = std::max(std::max(std::min(x0, x1), std::min(y0, y1)), std::max(std::min(z0, z1), _T(0)));
+			_T const exit = std::min(std::min(std::max(x0, x1), std::max(y0, y1)), std::min(std::max(z0, z1), packet.t_max[i]));
+
+			if (t_enter) t_enter[i] = entry;
+			mask |= std::uint32_t(entry <= exit) << i;
+		}
+		return mask;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	// tracing.
+
+	/// closest hit of every ray in [first, last) against every triangle,
+	/// in packets of _N rays spread over threads workers (zero uses the
+	/// hardware concurrency). this is a brute-force sweep; callers with an
+	/// acceleration structure drive the kernels above directly.
+	template <std::size_t _N = 8, typename _T, std::size_t _W, typename _InputIt>
+	std::vector<ray_hit<_T>> trace(triangle_blocks<_T, _W> const& triangles, _InputIt first, _InputIt last,
+		_T distance = std::numeric_limits<_T>::infinity(), unsigned threads = 0) {
+			std::vector<ray<_T>> rays(first, last);
+			std::vector<ray_hit<_T>> hits(rays.size());
+
+			std::size_t const packets = (rays.size() + _N - 1) / _N;
+			if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+			std::size_t const workers = std::max<std::size_t>(1, std::min<std::size_t>(threads, packets));
+
+			auto const work = [&](std::size_t w) {
+				ray_packet<_T, _N> packet;
+				for (std::size_t p = packets * w / workers; p != packets * (w + 1) / workers; ++p) {
+					std::size_t const base = p * _N;
+					std::size_t const n = std::min(_N, rays.size() - base);
+					packet = ray_packet<_T, _N>();
+					for (std::size_t i = 0; i < n; ++i) packet.set(i, rays[base + i], distance);
+
+					for (auto const& block : triangles) intersect(packet, block);
+					for (std::size_t i = 0; i < n; ++i) hits[base + i] = packet.hit(i);
+				}
+			};
+
+			std::vector<std::thread> pool;
+			for (std::size_t w = 1; w < workers; ++w) pool.emplace_back(work, w);
+			work(0);
+			for (auto& t : pool) t.join();
+			return hits;
+		}
+}
+
+#endif // _MATH_INTERSECTION_HPP
@@ -0,0 +1,169 @@
+#ifndef _MATH_KERNELS_HPP
+#define _MATH_KERNELS_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace math {
+
+	namespace internal {
+
+		////////////////////////////////////////////////////////////////////////////////
+		// polynomial coefficients for the branch-free kernels below.
+		// sin/cos are minimax fits on [-pi/4, pi/4] (cephes for float, fdlibm
+		// for double), atan is fitted on [-tan(pi/8), tan(pi/8)].
+
+		template <typename _T>
+		struct kernel_traits {
+			static_assert(!std::is_same<_T, _T>::value,
+				"the branch-free kernels are implemented for float and double only.");
+		};
+
+		template <>
+		struct kernel_traits<float> {
+			typedef std::int32_t int_type;
+
+			static constexpr float pi() noexcept { return 3.14159265358979323846f; }
+			static constexpr float half_pi() noexcept { return 1.57079632679489661923f; }
+			static constexpr float quarter_pi() noexcept { return 0.78539816339744830962f; }
+			static constexpr float two_over_pi() noexcept { return 0.63661977236758134308f; }
+			static constexpr float tan_eighth_pi() noexcept { return 0.41421356237309504880f; }
+
+			// steps between exact re-evaluations in sin/cos rotation recurrences.
+			static constexpr std::size_t recurrence_interval() noexcept { return 16; }
+
+			// pi/2 split into three parts for cody-waite range reduction.
+			static constexpr float half_pi_1() noexcept { return 1.5703125f; }
+			static constexpr float half_pi_2() noexcept { return 4.837512969970703125e-4f; }
+			static constexpr float half_pi_3() noexcept { return 7.54978995489188216e-8f; }
+
+			static float sin_poly(float x, float z) noexcept {
+				return x + x * z * (-1.6666654611e-1f + z * (8.3321608736e-3f + z * -1.9515295891e-4f));
+			}
+
+			static float cos_poly(float z) noexcept {
+				return 1.0f - 0.5f * z + z * z * (4.166664568298827e-2f
+					+ z * (-1.388731625493765e-3f + z * 2.443315711809948e-5f));
+			}
+
+			static float atan_poly(float x, float z) noexcept {
+				return x + x * z * (-3.33329491539e-1f + z * (1.99777106478e-1f
+					+ z * (-1.38776856032e-1f + z * 8.05374449538e-2f)));
+			}
+		};
+
+		template <>
+		struct kernel_traits<double> {
+			typedef std::int32_t int_type;
+
+			static constexpr double pi() noexcept { return 3.14159265358979323846; }
+			static constexpr double half_pi() noexcept { return 1.57079632679489661923; }
+			static constexpr double quarter_pi() noexcept { return 0.78539816339744830962; }
+			static constexpr double two_over_pi() noexcept { return 0.63661977236758134308; }
+			static constexpr double tan_eighth_pi() noexcept { return 0.41421356237309504880; }
+
+			static constexpr std::size_t recurrence_interval() noexcept { return 256; }
+
+			static constexpr double half_pi_1() noexcept { return 1.57079632673412561417e+00; }
+			static constexpr double half_pi_2() noexcept { return 6.07710050630396597660e-11; }
+			static constexpr double half_pi_3() noexcept { return 2.02226624879595063154e-21; }
+
+			static double sin_poly(double x, double z) noexcept {
+				return x + x * z * (-1.66666666666666324348e-01 + z * (8.33333333332248946124e-03
+					+ z * (-1.98412698298579493134e-04 + z * (2.75573137070700676789e-06
+					+ z * (-2.50507602534068634195e-08 + z * 1.58969099521155010221e-10)))));
+			}
+
+			static double cos_poly(double z) noexcept {
+				return 1.0 - 0.5 * z + z * z * (4.16666666666666019037e-02 + z * (-1.38888888888741095749e-03
+					+ z * (2.48015872894767294178e-05 + z * (-2.75573143513906633035e-07
+					+ z * (2.08757232129817482790e-09 + z * -1.13596475577881948265e-11)))));
+			}
+
+			static double atan_poly(double x, double z) noexcept {
+				double const p = (((-8.750608600031904122785e-1 * z - 1.615753718733365076637e1) * z
+					- 7.500855792314704667340e1) * z - 1.228866684490136173410e2) * z - 6.485021904942025371773e1;
+				double const q = ((((z + 2.485846490142306297962e1) * z + 1.650270098316988542046e2) * z
+					+ 4.328810604912902668951e2) * z + 4.853903996359136964868e2) * z + 1.945506571482613964425e2;
+				return x + x * z * p / q;
+			}
+		};
+
+		////////////////////////////////////////////////////////////////////////////////
+		// kernels.
+		// these trade the special-case handling of the C library (errno,
+		// infinities, huge arguments) for straight-line code: fast_sincos and
+		// fast_atan2 vectorize at -O2 in a loop with a constant trip count;
+		// fast_hypot keeps the errno branch of std::sqrt and does not.
+		//
+		// fast_sincos is accurate for |x| within a few thousand revolutions of
+		// zero; larger finite arguments give unspecified (but defined) results,
+		// and nan or infinite arguments give nan.
+
+		template <typename _T>
+		inline void fast_sincos(_T x, _T& s, _T& c) noexcept {
+			typedef kernel_traits<_T> traits_t;
+			typedef typename traits_t::int_type int_t;
+
+			// |t| is clamped to 2^30 (nan included) so the conversion to int_t
+			// is defined.
+			_T const t = x * traits_t::two_over_pi() + (x < _T(0) ? _T(-0.5) : _T(0.5));
+			_T const a = std::abs(t);
+			int_t const q = static_cast<int_t>(std::copysign(a < _T(1 << 30) ? a : _T(1 << 30), t));
+			_T const k = static_cast<_T>(q);
+			// x - x is zero for finite x and nan otherwise.
+			_T const r = ((x - k * traits_t::half_pi_1()) - k * traits_t::half_pi_2()) - k * traits_t::half_pi_3() + (x - x);
+			_T const z = r * r;
+
+			_T const sr = traits_t::sin_poly(r, z);
+			_T const cr = traits_t::cos_poly(z);
+
+			_T const s0 = (q & 1) ? cr : sr;
+			_T const c0 = (q & 1) ? sr : cr;
+			s = (q & 2) ? -s0 : s0;
+			c = ((q + 1) & 2) ? -c0 : c0;
+		}
+
+		template <typename _T>
+		inline _T fast_atan2(_T y, _T x) noexcept {
+			typedef kernel_traits<_T> traits_t;
+
+			_T const ax = std::abs(x);
+			_T const ay = std::abs(y);
+			// every branch of the reduction is evaluated and blended with 0/1
+			// weights: with trapping math the compiler will not speculate a
+			// division or subtraction that only one side of a select needs, so a
+			// select here would keep the calling loop scalar. the divisor is at
+			// least denorm_min, so atan2(0, 0) is 0 / denorm_min = 0.
+			_T const a = std::min(ax, ay) / std::max(std::max(ax, ay), std::numeric_limits<_T>::denorm_min());
+			_T const reduce = static_cast<_T>(a > traits_t::tan_eighth_pi());
+			_T const t = a + reduce * ((a - _T(1)) / (a + _T(1)) - a);
+			_T r = traits_t::atan_poly(t, t * t) + reduce * traits_t::quarter_pi();
+
+			_T const swap = static_cast<_T>(ay > ax);
+			r = swap * traits_t::half_pi() + (_T(1) - _T(2) * swap) * r;
+			_T const flip = static_cast<_T>(x < _T(0));
+			r = flip * traits_t::pi() + (_T(1) - _T(2) * flip) * r;
+			return std::copysign(r, y);
+		}
+
+		/// sqrt of the sum of squares, without the rescaling std::hypot does:
+		/// the squares overflow once a component passes sqrt(max()) (about
+		/// 1.8e19 for float) and underflow below sqrt(min()) (about 1.1e-19).
+		template <typename _T>
+		inline _T fast_hypot(_T x, _T y) noexcept {
+			return std::sqrt(x * x + y * y);
+		}
+
+		template <typename _T>
+		inline _T fast_hypot(_T x, _T y, _T z) noexcept {
+			return std::sqrt(x * x + y * y + z * z);
+		}
+	}
+}
+
+#endif // _MATH_KERNELS_HPP
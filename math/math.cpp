@@ -0,0 +1,37 @@
+////////////////////////////////////////////////////////////////////////////////
+// the math library.
+// the headers stay usable on their own. defining MATH_EXTERN_TEMPLATES before
+// including them turns the common float and double instantiations listed at
+// the end of each header into extern declarations, and linking this library
+// supplies the one compiled copy, so translation units stop instantiating and
+// optimizing the same vector, matrix and angle code (and the gemm kernels)
+// over and over. at -O2 the compiler may still instantiate members it wants
+// to inline; the saving is largest in debug builds.
+
+#include <angle.hpp>
+#include <vector.hpp>
+#include <matrix.hpp>
+#include <dynamic_matrix.hpp>
+
+namespace math {
+
+	_MATH_ANGLE_INSTANTIATIONS(, float)
+	_MATH_ANGLE_INSTANTIATIONS(, double)
+
+	_MATH_VECTOR_INSTANTIATIONS(, float, 2)
+	_MATH_VECTOR_INSTANTIATIONS(, float, 3)
+	_MATH_VECTOR_INSTANTIATIONS(, float, 4)
+	_MATH_VECTOR_INSTANTIATIONS(, double, 2)
+	_MATH_VECTOR_INSTANTIATIONS(, double, 3)
+	_MATH_VECTOR_INSTANTIATIONS(, double, 4)
+
+	_MATH_MATRIX_INSTANTIATIONS(, float, 2)
+	_MATH_MATRIX_INSTANTIATIONS(, float, 3)
+	_MATH_MATRIX_INSTANTIATIONS(, float, 4)
+	_MATH_MATRIX_INSTANTIATIONS(, double, 2)
+	_MATH_MATRIX_INSTANTIATIONS(, double, 3)
+	_MATH_MATRIX_INSTANTIATIONS(, double, 4)
+
+	_MATH_DYNAMIC_MATRIX_INSTANTIATIONS(, float)
+	_MATH_DYNAMIC_MATRIX_INSTANTIATIONS(, double)
+}
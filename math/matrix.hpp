@@ -5,119 +5,495 @@
 #include <vector.hpp>
 #include <quaternion.hpp>
 #include <cmath>
+#include <utility>
 
 namespace math {
 
-	template <typename _T, std::size_t _M, std::size_t _N>
+	////////////////////////////////////////////////////////////////////////////////
+	// storage orders.
+	// offset() gives the position of element (row, column) in a matrix with the
+	// given number of rows and columns.
+
+	struct column_major {
+		static constexpr std::size_t offset(std::size_t row, std::size_t column, std::size_t rows, std::size_t) noexcept {
+			return column * rows + row;
+		}
+
+		static constexpr std::ptrdiff_t row_stride(std::size_t, std::size_t) noexcept { return 1; }
+		static constexpr std::ptrdiff_t column_stride(std::size_t rows, std::size_t) noexcept { return static_cast<std::ptrdiff_t>(rows); }
+	};
+
+	struct row_major {
+		static constexpr std::size_t offset(std::size_t row, std::size_t column, std::size_t, std::size_t columns) noexcept {
+			return row * columns + column;
+		}
+
+		static constexpr std::ptrdiff_t row_stride(std::size_t, std::size_t columns) noexcept { return static_cast<std::ptrdiff_t>(columns); }
+		static constexpr std::ptrdiff_t column_stride(std::size_t, std::size_t) noexcept { return 1; }
+	};
+
+	template <typename _T, std::size_t _M, std::size_t _N, typename _Order = column_major>
 	struct matrix;
 
+	/// strided view of _N elements, e.g. a row or column of a matrix. copying
+	/// the view copies the reference; assigning to it writes the elements.
 	template <typename _T, std::size_t _N>
 	struct linear_array {
+		typedef typename std::remove_const<_T>::type value_type;
+		typedef std::size_t size_type;
+		typedef std::ptrdiff_t difference_type;
 
-		linear_array operator -() const noexcept;
-		linear_array operator +() const noexcept;
+		constexpr linear_array(_T* data, difference_type stride) noexcept
+			: _data(data), _stride(stride) {}
 
-		linear_array& operator += (linear_array const& other);
-		linear_array& operator += (vector<_T, _N> const& other);
-		linear_array& operator -= (linear_array const& other);
-		linear_array& operator -= (vector<_T, _N> const& other);
-		linear_array& operator *= (_T const& scalar);
-		linear_array& operator /= (_T const& scalar);
+		constexpr linear_array(linear_array const&) = default;
+
+		constexpr _T& operator [](size_type index) const noexcept {
+			return _data[static_cast<difference_type>(index) * _stride];
+		}
+
+		constexpr size_type size() const noexcept { return _N; }
+		constexpr difference_type stride() const noexcept { return _stride; }
+		constexpr _T* data() const noexcept { return _data; }
+
+		constexpr operator vector<value_type, _N>() const noexcept {
+			vector<value_type, _N> result {};
+			for (size_type i = 0; i < _N; ++i) result[i] = (*this)[i];
+			return result;
+		}
+
+		////////////////////////////////////////////////////////////////////////////////
+		// assignment operators.
+
+		constexpr linear_array& operator = (linear_array const& other) noexcept {
+			return *this = static_cast<vector<value_type, _N>>(other);
+		}
+
+		constexpr linear_array& operator = (vector<value_type, _N> const& other) noexcept {
+			for (size_type i = 0; i < _N; ++i) (*this)[i] = other[i];
+			return *this;
+		}
+
+		////////////////////////////////////////////////////////////////////////////////
+		// unary arithmetic operators.
+
+		constexpr vector<value_type, _N> operator -() const noexcept {
+			return -static_cast<vector<value_type, _N>>(*this);
+		}
+
+		constexpr vector<value_type, _N> operator +() const noexcept {
+			return *this;
+		}
+
+		////////////////////////////////////////////////////////////////////////////////
+		// compound arithmetic operators.
+
+		constexpr linear_array& operator += (linear_array const& other) noexcept {
+			return *this += static_cast<vector<value_type, _N>>(other);
+		}
+
+		constexpr linear_array& operator += (vector<value_type, _N> const& other) noexcept {
+			for (size_type i = 0; i < _N; ++i) (*this)[i] += other[i];
+			return *this;
+		}
+
+		constexpr linear_array& operator -= (linear_array const& other) noexcept {
+			return *this -= static_cast<vector<value_type, _N>>(other);
+		}
+
+		constexpr linear_array& operator -= (vector<value_type, _N> const& other) noexcept {
+			for (size_type i = 0; i < _N; ++i) (*this)[i] -= other[i];
+			return *this;
+		}
+
+		constexpr linear_array& operator *= (value_type const& scalar) noexcept {
+			for (size_type i = 0; i < _N; ++i) (*this)[i] *= scalar;
+			return *this;
+		}
+
+		constexpr linear_array& operator /= (value_type const& scalar) noexcept {
+			for (size_type i = 0; i < _N; ++i) (*this)[i] /= scalar;
+			return *this;
+		}
+
+	private:
+		_T* _data;
+		difference_type _stride;
+	};
+
+	/// strided view of an _M column by _N row matrix held elsewhere: a
+	/// transposed matrix, a block of one, or foreign storage such as a BLAS
+	/// buffer. element (row, column) lives at data()[row * row_stride() +
+	/// column * column_stride()].
+	template <typename _T, std::size_t _M, std::size_t _N>
+	struct matrix_view {
+		typedef typename std::remove_const<_T>::type value_type;
+		typedef std::size_t size_type;
+		typedef std::ptrdiff_t difference_type;
+
+		constexpr matrix_view(_T* data, difference_type row_stride, difference_type column_stride) noexcept
+			: _data(data), _row_stride(row_stride), _column_stride(column_stride) {}
+
+		constexpr matrix_view(matrix_view const&) = default;
+
+		////////////////////////////////////////////////////////////////////////////////
+		// element access.
+
+		constexpr _T& operator ()(size_type row, size_type column) const noexcept {
+			return _data[static_cast<difference_type>(row) * _row_stride + static_cast<difference_type>(column) * _column_stride];
+		}
+
+		/// column index.
+		constexpr linear_array<_T, _N> operator [](size_type index) const noexcept {
+			return linear_array<_T, _N>(&(*this)(0, index), _row_stride);
+		}
+
+		constexpr linear_array<_T, _M> row(size_type index) const noexcept {
+			return linear_array<_T, _M>(&(*this)(index, 0), _column_stride);
+		}
+
+		constexpr _T* data() const noexcept { return _data; }
+		constexpr difference_type row_stride() const noexcept { return _row_stride; }
+		constexpr difference_type column_stride() const noexcept { return _column_stride; }
+
+		////////////////////////////////////////////////////////////////////////////////
+		// views.
+
+		constexpr matrix_view<_T, _N, _M> transposed() const noexcept {
+			return matrix_view<_T, _N, _M>(_data, _column_stride, _row_stride);
+		}
+
+		/// the _Columns by _Rows block whose top-left element is (row, column).
+		template <std::size_t _Columns, std::size_t _Rows>
+		constexpr matrix_view<_T, _Columns, _Rows> block(size_type row, size_type column) const noexcept {
+			static_assert(_Columns <= _M && _Rows <= _N, "matrix_view<T, M, N>::block requires a smaller block.");
+			return matrix_view<_T, _Columns, _Rows>(&(*this)(row, column), _row_stride, _column_stride);
+		}
+
+		////////////////////////////////////////////////////////////////////////////////
+		// assignment operators.
+
+		constexpr matrix_view& operator = (matrix_view const& other) noexcept {
+			return *this = static_cast<matrix<value_type, _M, _N>>(other);
+		}
+
+		template <typename _T2, typename _Order>
+		constexpr matrix_view& operator = (matrix<_T2, _M, _N, _Order> const& other) noexcept {
+			for (size_type c = 0; c < _M; ++c)
+				for (size_type r = 0; r < _N; ++r)
+					(*this)(r, c) = static_cast<value_type>(other(r, c));
+			return *this;
+		}
+
+		////////////////////////////////////////////////////////////////////////////////
+		// conversion operators.
+
+		template <typename _T2, typename _Order>
+		constexpr operator matrix<_T2, _M, _N, _Order>() const noexcept {
+			matrix<_T2, _M, _N, _Order> result {};
+			for (size_type c = 0; c < _M; ++c)
+				for (size_type r = 0; r < _N; ++r)
+					result(r, c) = static_cast<_T2>((*this)(r, c));
+			return result;
+		}
+
+	private:
+		_T* _data;
+		difference_type _row_stride;
+		difference_type _column_stride;
 	};
 
 	namespace internal {
 		template <typename _MatrixT> struct matrix_identity {};
 		template <typename _MatrixT> struct matrix_transforms {};
 
-		template <typename _T, std::size_t _N>
-		struct matrix_identity<matrix<_T, _N, _N>> {
-			static const matrix<_T, _N, _N> identity;
+		template <typename _T, std::size_t _N, typename _Order>
+		struct matrix_identity<matrix<_T, _N, _N, _Order>> {
+			static constexpr matrix<_T, _N, _N, _Order> identity() noexcept;
 		};
 
+		////////////////////////////////////////////////////////////////////////
+		// the transforms treat points as column vectors (p' = m * p) with the
+		// translation in the last column. the verbs (scale, translate, rotate)
+		// post-multiply the matrix by the corresponding transform, the nouns
+		// overwrite or read back the relevant part of the matrix.
+
 		////////////////////////////////////////////////////////////////////////
 		// 2-dimensional matrix transforms.
 
-		template <typename _T>
-		struct matrix_transforms<matrix<_T, 3, 3>> {
+		template <typename _T, typename _Order>
+		struct matrix_transforms<matrix<_T, 3, 3, _Order>> {
 
 			////////////////////////////////////////////////////////////////////////
 			// scaling.
 
-			void scale(vector2<_T> const& scale) noexcept;
+			constexpr void scale(vector2<_T> const& scale) noexcept {
+				for (std::size_t r = 0; r < 3; ++r) {
+					_self()(r, 0) *= scale.x;
+					_self()(r, 1) *= scale.y;
+				}
+			}
 
-			vector2<_T> scale() const noexcept;
+			vector2<_T> scale() const noexcept {
+				return vector2<_T> {
+					static_cast<_T>(std::hypot(_self()(0, 0), _self()(1, 0))),
+					static_cast<_T>(std::hypot(_self()(0, 1), _self()(1, 1))) };
+			}
 
 			////////////////////////////////////////////////////////////////////////
 			// translation.
 
-			void translate(vector2<_T> const& translation) noexcept;
-			void translation(vector2<_T> const& translation) noexcept;
+			constexpr void translate(vector2<_T> const& translation) noexcept {
+				translate(translation.x, translation.y);
+			}
+
+			constexpr void translation(vector2<_T> const& translation) noexcept {
+				this->translation(translation.x, translation.y);
+			}
+
+			constexpr void translate(_T const& x, _T const& y) noexcept {
+				for (std::size_t r = 0; r < 3; ++r)
+					_self()(r, 2) += _self()(r, 0) * x + _self()(r, 1) * y;
+			}
 
-			void translate(_T const& x, _T const& y) noexcept;
-			void translation(_T const& x, _T const& y) noexcept;
+			constexpr void translation(_T const& x, _T const& y) noexcept {
+				_self()(0, 2) = x;
+				_self()(1, 2) = y;
+			}
 
-			vector2<_T> translation() const noexcept;
+			constexpr vector2<_T> translation() const noexcept {
+				return vector2<_T> { _self()(0, 2), _self()(1, 2) };
+			}
 
 			////////////////////////////////////////////////////////////////////////
 			// rotation.
 
-			void rotate(radians<_T> const& angle) noexcept;
-			void rotation(radians<_T> const& angle) noexcept;
-
-			radians<_T> rotation() const noexcept;
+			constexpr void rotate(radians<_T> const& angle) noexcept {
+				matrix<_T, 3, 3, _Order> rotation = matrix<_T, 3, 3, _Order>::identity();
+				rotation.rotation(angle);
+				_self() *= rotation;
+			}
+
+			constexpr void rotation(radians<_T> const& angle) noexcept {
+				_T const c = internal::constexpr_cos(angle), s = internal::constexpr_sin(angle);
+				_self()(0, 0) = c; _self()(0, 1) = -s;
+				_self()(1, 0) = s; _self()(1, 1) = c;
+			}
+
+			radians<_T> rotation() const noexcept {
+				return radians<_T> { std::atan2(_self()(1, 0), _self()(0, 0)) };
+			}
+
+		private:
+			constexpr matrix<_T, 3, 3, _Order>& _self() noexcept { return static_cast<matrix<_T, 3, 3, _Order>&>(*this); }
+			constexpr matrix<_T, 3, 3, _Order> const& _self() const noexcept { return static_cast<matrix<_T, 3, 3, _Order> const&>(*this); }
 		};
 
 		////////////////////////////////////////////////////////////////////////
 		// 3-dimensional matrix transforms.
 
-		template <typename _T>
-		struct matrix_transforms<matrix<_T, 4, 4>> {
+		template <typename _T, typename _Order>
+		struct matrix_transforms<matrix<_T, 4, 4, _Order>> {
 
 			////////////////////////////////////////////////////////////////////////
 			// scaling.
 
-			void scale(vector3<_T> const& scale) noexcept;
-
-			vector3<_T> scale() const noexcept;
+			constexpr void scale(vector3<_T> const& scale) noexcept {
+				for (std::size_t r = 0; r < 4; ++r) {
+					_self()(r, 0) *= scale.x;
+					_self()(r, 1) *= scale.y;
+					_self()(r, 2) *= scale.z;
+				}
+			}
+
+			vector3<_T> scale() const noexcept {
+				vector3<_T> result;
+				for (std::size_t c = 0; c < 3; ++c) {
+					result[c] = static_cast<_T>(std::sqrt(_self()(0, c) * _self()(0, c)
+						+ _self()(1, c) * _self()(1, c) + _self()(2, c) * _self()(2, c)));
+				}
+				return result;
+			}
 
 			////////////////////////////////////////////////////////////////////////
 			// translation.
 
-			void translate(vector3<_T> const& translation) noexcept;
-			void translation(vector3<_T> const& translation) noexcept;
+			constexpr void translate(vector3<_T> const& translation) noexcept {
+				translate(translation.x, translation.y, translation.z);
+			}
 
-			void translate(_T const& x, _T const& y, _T const& z) noexcept;
-			void translation(_T const& x, _T const& y, _T const& z) noexcept;
+			constexpr void translation(vector3<_T> const& translation) noexcept {
+				this->translation(translation.x, translation.y, translation.z);
+			}
 
-			vector3<_T> translation() const noexcept;
+			constexpr void translate(_T const& x, _T const& y, _T const& z) noexcept {
+				for (std::size_t r = 0; r < 4; ++r)
+					_self()(r, 3) += _self()(r, 0) * x + _self()(r, 1) * y + _self()(r, 2) * z;
+			}
+
+			constexpr void translation(_T const& x, _T const& y, _T const& z) noexcept {
+				_self()(0, 3) = x;
+				_self()(1, 3) = y;
+				_self()(2, 3) = z;
+			}
+
+			constexpr vector3<_T> translation() const noexcept {
+				return vector3<_T> { _self()(0, 3), _self()(1, 3), _self()(2, 3) };
+			}
 
 			////////////////////////////////////////////////////////////////////////
 			// rotation.
+			// the getters decompose the upper 3x3 block as zrotation * yrotation *
+			// xrotation and assume it holds no scale.
+
+			constexpr void xrotate(radians<_T> const& angle) noexcept { _rotate(angle, 1, 2); }
+			constexpr void xrotation(radians<_T> const& angle) noexcept { _rotation(angle, 1, 2); }
+
+			constexpr void yrotate(radians<_T> const& angle) noexcept { _rotate(angle, 2, 0); }
+			constexpr void yrotation(radians<_T> const& angle) noexcept { _rotation(angle, 2, 0); }
+
+			constexpr void zrotate(radians<_T> const& angle) noexcept { _rotate(angle, 0, 1); }
+			constexpr void zrotation(radians<_T> const& angle) noexcept { _rotation(angle, 0, 1); }
+
+			radians<_T> xrotation() const noexcept {
+				return radians<_T> { std::atan2(_self()(2, 1), _self()(2, 2)) };
+			}
+
+			radians<_T> yrotation() const noexcept {
+				return radians<_T> { std::asin(-_self()(2, 0)) };
+			}
+
+			radians<_T> zrotation() const noexcept {
+				return radians<_T> { std::atan2(_self()(1, 0), _self()(0, 0)) };
+			}
+
+		private:
+			constexpr matrix<_T, 4, 4, _Order>& _self() noexcept { return static_cast<matrix<_T, 4, 4, _Order>&>(*this); }
+			constexpr matrix<_T, 4, 4, _Order> const& _self() const noexcept { return static_cast<matrix<_T, 4, 4, _Order> const&>(*this); }
+
+			// rotation in the plane of axes a and b, taking a towards b.
+			constexpr void _rotation(radians<_T> const& angle, std::size_t a, std::size_t b) noexcept {
+				_T const c = internal::constexpr_cos(angle), s = internal::constexpr_sin(angle);
+				for (std::size_t r = 0; r < 3; ++r)
+					for (std::size_t k = 0; k < 3; ++k)
+						_self()(r, k) = r == k ? _T(1) : _T(0);
+				_self()(a, a) = c; _self()(a, b) = -s;
+				_self()(b, a) = s; _self()(b, b) = c;
+			}
+
+			constexpr void _rotate(radians<_T> const& angle, std::size_t a, std::size_t b) noexcept {
+				matrix<_T, 4, 4, _Order> rotation = matrix<_T, 4, 4, _Order>::identity();
+				rotation._rotation(angle, a, b);
+				_self() *= rotation;
+			}
+		};
+	}
 
-			void xrotate(radians<_T> const& angle) noexcept;
-			void xrotation(radians<_T> const& angle) noexcept;
+	namespace internal {
 
-			void yrotate(radians<_T> const& angle) noexcept;
-			void yrotation(radians<_T> const& angle) noexcept;
+		////////////////////////////////////////////////////////////////////////
+		// square matrix algorithms.
+		// these work on any matrix-like type with operator ()(row, column),
+		// taking an n x n working copy by reference and overwriting it. the
+		// fixed-size and dynamic-size matrices share them.
 
-			void zrotate(radians<_T> const& angle) noexcept;
-			void zrotation(radians<_T> const& angle) noexcept;
+		template <typename _T>
+		inline _T magnitude(_T const& value) noexcept {
+			using std::abs;
+			return abs(value);
+		}
 
-			radians<_T> xrotation() const noexcept;
-			radians<_T> yrotation() const noexcept;
-			radians<_T> zrotation() const noexcept;
-		};
+		/// gaussian elimination with partial pivoting.
+		template <typename _Matrix, typename _T>
+		_T determinant(_Matrix& a, std::size_t n) noexcept {
+			_T result = _T(1);
+			for (std::size_t k = 0; k < n; ++k) {
+				std::size_t p = k;
+				for (std::size_t r = k + 1; r < n; ++r)
+					if (magnitude(a(r, k)) > magnitude(a(p, k))) p = r;
+				if (a(p, k) == _T(0)) return _T(0);
+				if (p != k) {
+					for (std::size_t c = k; c < n; ++c) std::swap(a(p, c), a(k, c));
+					result = -result;
+				}
+
+				result *= a(k, k);
+				for (std::size_t r = k + 1; r < n; ++r) {
+					_T const f = a(r, k) / a(k, k);
+					for (std::size_t c = k + 1; c < n; ++c) a(r, c) -= f * a(k, c);
+				}
+			}
+			return result;
+		}
+
+		/// gauss-jordan elimination with partial pivoting; result must hold the
+		/// identity on entry. a singular matrix divides by zero.
+		template <typename _Matrix, typename _T>
+		void inverse(_Matrix& a, _Matrix& result, std::size_t n) noexcept {
+			for (std::size_t k = 0; k < n; ++k) {
+				std::size_t p = k;
+				for (std::size_t r = k + 1; r < n; ++r)
+					if (magnitude(a(r, k)) > magnitude(a(p, k))) p = r;
+				if (p != k) {
+					for (std::size_t c = 0; c < n; ++c) {
+						std::swap(a(p, c), a(k, c));
+						std::swap(result(p, c), result(k, c));
+					}
+				}
+
+				_T const d = a(k, k);
+				for (std::size_t c = 0; c < n; ++c) {
+					a(k, c) /= d;
+					result(k, c) /= d;
+				}
+
+				for (std::size_t r = 0; r < n; ++r) {
+					if (r == k) continue;
+					_T const f = a(r, k);
+					for (std::size_t c = 0; c < n; ++c) {
+						a(r, c) -= f * a(k, c);
+						result(r, c) -= f * result(k, c);
+					}
+				}
+			}
+		}
+
+		/// doolittle decomposition without pivoting: u on and above the
+		/// diagonal, l (with an implied unit diagonal) below it.
+		template <typename _Matrix, typename _T>
+		void decompose(_Matrix& a, std::size_t n) noexcept {
+			for (std::size_t k = 0; k < n; ++k) {
+				for (std::size_t r = k + 1; r < n; ++r) {
+					a(r, k) /= a(k, k);
+					for (std::size_t c = k + 1; c < n; ++c) a(r, c) -= a(r, k) * a(k, c);
+				}
+			}
+		}
+
+		/// splits a packed decomposition in place into its upper or lower
+		/// (unit diagonal) factor.
+		template <typename _Matrix, typename _T>
+		void triangle(_Matrix& a, std::size_t n, bool upper) noexcept {
+			for (std::size_t c = 0; c < n; ++c) {
+				for (std::size_t r = 0; r < n; ++r) {
+					if (r == c) { if (!upper) a(r, c) = _T(1); }
+					else if ((r > c) == upper) a(r, c) = _T(0);
+				}
+			}
+		}
 	}
 
 	/// _T = type of values
 	/// _M = number of columns
 	/// _N = number of rows
-	template <typename _T, std::size_t _M, std::size_t _N>
+	/// _Order = storage order (column_major or row_major); element (row, column)
+	/// lives at data()[_Order::offset(row, column, _N, _M)].
+	template <typename _T, std::size_t _M, std::size_t _N, typename _Order>
 	struct matrix :
-		public internal::matrix_identity<matrix<_T, _M, _N>>,
-		public internal::matrix_transforms<matrix<_T, _M, _N>> {
+		public internal::matrix_identity<matrix<_T, _M, _N, _Order>>,
+		public internal::matrix_transforms<matrix<_T, _M, _N, _Order>> {
 
-		static_assert(std::is_arithmetic<_T>::value,
+		static_assert(math::is_arithmetic<_T>::value,
 			"matrix<T, M, N> requires arithmetic type.");
 
 		typedef _T value_type;
@@ -127,6 +503,7 @@ namespace math {
 		typedef _T const& const_reference;
 		typedef std::size_t size_type;
 		typedef std::ptrdiff_t difference_type;
+		typedef _Order order_type;
 
 		typedef _T* iterator;
 		typedef _T const* const_iterator;
@@ -134,88 +511,296 @@ namespace math {
 		typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
 
 		////////////////////////////////////////////////////////////////////////////////
+		// constructors.
 
-		linear_array<_T, _N> operator [](size_type index) noexcept;
-		linear_array<_T, _N> const operator [](size_type index) const noexcept;
+		constexpr matrix() = default;
+
+		////////////////////////////////////////////////////////////////////////////////
+		// element access.
+
+		/// column index, as in m[column][row].
+		constexpr linear_array<_T, _N> operator [](size_type index) noexcept {
+			return view()[index];
+		}
+
+		constexpr linear_array<_T const, _N> operator [](size_type index) const noexcept {
+			return view()[index];
+		}
+
+		constexpr linear_array<_T, _M> row(size_type index) noexcept {
+			return view().row(index);
+		}
+
+		constexpr linear_array<_T const, _M> row(size_type index) const noexcept {
+			return view().row(index);
+		}
+
+		constexpr reference operator ()(size_type row, size_type column) noexcept {
+			return _data[_Order::offset(row, column, _N, _M)];
+		}
+
+		constexpr const_reference operator ()(size_type row, size_type column) const noexcept {
+			return _data[_Order::offset(row, column, _N, _M)];
+		}
+
+		////////////////////////////////////////////////////////////////////////////////
+		// views.
+
+		constexpr matrix_view<_T, _M, _N> view() noexcept {
+			return matrix_view<_T, _M, _N>(_data, _Order::row_stride(_N, _M), _Order::column_stride(_N, _M));
+		}
+
+		constexpr matrix_view<_T const, _M, _N> view() const noexcept {
+			return matrix_view<_T const, _M, _N>(_data, _Order::row_stride(_N, _M), _Order::column_stride(_N, _M));
+		}
+
+		constexpr matrix_view<_T, _N, _M> transposed() noexcept { return view().transposed(); }
+		constexpr matrix_view<_T const, _N, _M> transposed() const noexcept { return view().transposed(); }
+
+		template <std::size_t _Columns, std::size_t _Rows>
+		constexpr matrix_view<_T, _Columns, _Rows> block(size_type row, size_type column) noexcept {
+			return view().template block<_Columns, _Rows>(row, column);
+		}
+
+		template <std::size_t _Columns, std::size_t _Rows>
+		constexpr matrix_view<_T const, _Columns, _Rows> block(size_type row, size_type column) const noexcept {
+			return view().template block<_Columns, _Rows>(row, column);
+		}
 
 		////////////////////////////////////////////////////////////////////////////////
 		// unary arithmetic operators.
 
-		matrix operator +() const noexcept {
+		constexpr matrix operator +() const noexcept {
 			return *this;
 		}
 
-		matrix operator -() const noexcept {
-			return -1 * (*this);
+		constexpr matrix operator -() const noexcept {
+			matrix result {};
+			for (size_type i = 0; i < _M * _N; ++i) result._data[i] = -_data[i];
+			return result;
 		}
 
 		////////////////////////////////////////////////////////////////////////////////
 		// compound arithmetic operators.
 
-		matrix& operator += (matrix const& other) noexcept {
-			std::transform(this->begin(), this->end(), other.begin(),
-				this->begin(), std::plus<_T>());
+		constexpr matrix& operator += (matrix const& other) noexcept {
+			for (size_type i = 0; i < _M * _N; ++i) _data[i] += other._data[i];
 			return *this;
 		}
 
-		matrix& operator -= (matrix const& other) noexcept {
-			std::transform(this->begin(), this->end(), other.begin(),
-				this->begin(), std::minus<_T>());
+		constexpr matrix& operator -= (matrix const& other) noexcept {
+			for (size_type i = 0; i < _M * _N; ++i) _data[i] -= other._data[i];
 			return *this;
 		}
 
-		matrix& operator *= (matrix const& other) noexcept;
+		constexpr matrix& operator *= (matrix const& other) noexcept {
+			static_assert(_M == _N, "matrix<T, M, N>::operator *= requires a square matrix.");
+			return *this = *this * other;
+		}
 
-		matrix& operator *= (value_type const& scalar) noexcept {
-			std::transform(this->begin(), this->end(), this->begin(),
-				std::bind(std::multiplies<_T>(), std::placeholders::_1, scalar));
+		constexpr matrix& operator *= (value_type const& scalar) noexcept {
+			for (size_type i = 0; i < _M * _N; ++i) _data[i] *= scalar;
 			return *this;
 		}
 
-		matrix& operator /= (value_type const& scalar) noexcept {
-			std::transform(this->begin(), this->end(), this->begin(),
-				std::bind(std::divides<_T>(), std::placeholders::_1, scalar));
+		constexpr matrix& operator /= (value_type const& scalar) noexcept {
+			for (size_type i = 0; i < _M * _N; ++i) _data[i] /= scalar;
 			return *this;
 		}
 
 
-		typename std::common_type<_T, float>::type determinant() const noexcept;
+		////////////////////////////////////////////////////////////////////////////////
+		// square matrix operations.
+		// computed in at least single precision and converted back to _T.
+
+		typename std::common_type<_T, float>::type determinant() const noexcept {
+			static_assert(_M == _N, "matrix<T, M, N>::determinant requires a square matrix.");
+			typedef typename std::common_type<_T, float>::type work_t;
+			matrix<work_t, _M, _N, _Order> a = *this;
+			return internal::determinant<matrix<work_t, _M, _N, _Order>, work_t>(a, _N);
+		}
 
-		matrix inverse() const noexcept;
-		matrix decompose() const noexcept;
+		/// the inverse, found by gauss-jordan elimination with partial pivoting.
+		/// a singular matrix gives non-finite elements.
+		matrix inverse() const noexcept {
+			static_assert(_M == _N, "matrix<T, M, N>::inverse requires a square matrix.");
+			typedef typename std::common_type<_T, float>::type work_t;
+			matrix<work_t, _M, _N, _Order> a = *this;
+			matrix<work_t, _M, _N, _Order> result = matrix<work_t, _M, _N, _Order>::identity();
+			internal::inverse<matrix<work_t, _M, _N, _Order>, work_t>(a, result, _N);
+			return result;
+		}
+
+		/// the lu decomposition packed into one matrix: u on and above the
+		/// diagonal, l below it with an implied unit diagonal. no pivoting is
+		/// done, so every leading principal minor must be non-zero.
+		matrix decompose() const noexcept {
+			static_assert(_M == _N, "matrix<T, M, N>::decompose requires a square matrix.");
+			typedef typename std::common_type<_T, float>::type work_t;
+			matrix<work_t, _M, _N, _Order> a = *this;
+			internal::decompose<matrix<work_t, _M, _N, _Order>, work_t>(a, _N);
+			return a;
+		}
+
+		matrix upper_decompose() const noexcept {
+			matrix result = decompose();
+			internal::triangle<matrix, _T>(result, _N, true);
+			return result;
+		}
 
-		matrix upper_decompose() const noexcept;
-		matrix lower_decompose() const noexcept;
+		matrix lower_decompose() const noexcept {
+			matrix result = decompose();
+			internal::triangle<matrix, _T>(result, _N, false);
+			return result;
+		}
 
-		pointer data() noexcept {
+		constexpr pointer data() noexcept {
 			return _data;
 		}
 
-		const_pointer data() const noexcept {
+		constexpr const_pointer data() const noexcept {
 			return _data;
 		}
 
-		iterator begin() noexcept { return { &_data[0]; } }
-		iterator end() noexcept { return { &_data[_M * _N]; } }
-		const_iterator begin() const noexcept { return { &_data[0]; } }
-		const_iterator end() const noexcept { return { &_data[_M * _N]; } }
-		const_iterator cbegin() const noexcept { return { &_data[0]; } }
-		const_iterator cend() const noexcept { return { &_data[_M * _N]; } }
+		constexpr iterator begin() noexcept { return &_data[0]; }
+		constexpr iterator end() noexcept { return &_data[0] + _M * _N; }
+		constexpr const_iterator begin() const noexcept { return &_data[0]; }
+		constexpr const_iterator end() const noexcept { return &_data[0] + _M * _N; }
+		constexpr const_iterator cbegin() const noexcept { return &_data[0]; }
+		constexpr const_iterator cend() const noexcept { return &_data[0] + _M * _N; }
+
+		reverse_iterator rbegin() noexcept { return reverse_iterator(this->end()); }
+		reverse_iterator rend() noexcept { return reverse_iterator(this->begin()); }
+		const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(this->end()); }
+		const_reverse_iterator rend() const noexcept { return const_reverse_iterator(this->begin()); }
+		const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator(this->cend()); }
+		const_reverse_iterator crend() const noexcept { return const_reverse_iterator(this->cbegin()); }
 
-		reverse_iterator rbegin() noexcept { return this->end(); }
-		reverse_iterator rend() noexcept { return this->begin(); }
-		const_reverse_iterator rbegin() const noexcept { return this->end(); }
-		const_reverse_iterator rend() const noexcept { return this->begin(); }
-		const_reverse_iterator crbegin() const noexcept { return this->cend(); }
-		const_reverse_iterator crend() const noexcept { return this->cbegin(); }
+		////////////////////////////////////////////////////////////////////////////////
+		// conversion operators.
+
+		/// converts the value type and/or the storage order.
+		template <typename _T2, typename _Order2>
+		constexpr operator matrix<_T2, _M, _N, _Order2>() const noexcept {
+			matrix<_T2, _M, _N, _Order2> result {};
+			for (size_type c = 0; c < _M; ++c)
+				for (size_type r = 0; r < _N; ++r)
+					result(r, c) = static_cast<_T2>((*this)(r, c));
+			return result;
+		}
 
 	private:
 		value_type _data[_M * _N];
 	};
 
-	template <typename _T> using matrix2x2 = matrix<_T, 2, 2>;
-	template <typename _T> using matrix3x3 = matrix<_T, 3, 3>;
-	template <typename _T> using matrix4x4 = matrix<_T, 4, 4>;
+	template <typename _T, typename _Order = column_major> using matrix2x2 = matrix<_T, 2, 2, _Order>;
+	template <typename _T, typename _Order = column_major> using matrix3x3 = matrix<_T, 3, 3, _Order>;
+	template <typename _T, typename _Order = column_major> using matrix4x4 = matrix<_T, 4, 4, _Order>;
+
+	namespace internal {
+		template <typename _T, std::size_t _N, typename _Order>
+		constexpr matrix<_T, _N, _N, _Order> matrix_identity<matrix<_T, _N, _N, _Order>>::identity() noexcept {
+			matrix<_T, _N, _N, _Order> result {};
+			for (std::size_t i = 0; i < _N; ++i) result(i, i) = static_cast<_T>(1);
+			return result;
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	// equality operators.
+
+	template <typename _T1, typename _T2, std::size_t _M, std::size_t _N, typename _O1, typename _O2>
+	constexpr bool operator == (matrix<_T1, _M, _N, _O1> const& lhs, matrix<_T2, _M, _N, _O2> const& rhs) {
+		for (std::size_t c = 0; c < _M; ++c)
+			for (std::size_t r = 0; r < _N; ++r)
+				if (!(lhs(r, c) == rhs(r, c))) return false;
+		return true;
+	}
+
+	template <typename _T1, typename _T2, std::size_t _M, std::size_t _N, typename _O1, typename _O2>
+	constexpr bool operator != (matrix<_T1, _M, _N, _O1> const& lhs, matrix<_T2, _M, _N, _O2> const& rhs) {
+		return !(lhs == rhs);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	// binary arithmetic operators.
+
+	template <typename _T1, typename _T2, std::size_t _M, std::size_t _N, typename _O1, typename _O2>
+	inline constexpr matrix<typename std::common_type<_T1, _T2>::type, _M, _N, _O1> operator + (matrix<_T1, _M, _N, _O1> const& lhs, matrix<_T2, _M, _N, _O2> const& rhs) {
+		typedef typename std::common_type<_T1, _T2>::type common_t;
+		return matrix<common_t, _M, _N, _O1>(lhs) += matrix<common_t, _M, _N, _O1>(rhs);
+	}
+
+	template <typename _T1, typename _T2, std::size_t _M, std::size_t _N, typename _O1, typename _O2>
+	inline constexpr matrix<typename std::common_type<_T1, _T2>::type, _M, _N, _O1> operator - (matrix<_T1, _M, _N, _O1> const& lhs, matrix<_T2, _M, _N, _O2> const& rhs) {
+		typedef typename std::common_type<_T1, _T2>::type common_t;
+		return matrix<common_t, _M, _N, _O1>(lhs) -= matrix<common_t, _M, _N, _O1>(rhs);
+	}
+
+	template <typename _T1, typename _T2, std::size_t _M, std::size_t _N, typename _Order>
+	inline constexpr matrix<typename std::common_type<_T1, _T2>::type, _M, _N, _Order> operator * (matrix<_T1, _M, _N, _Order> const& mat, _T2 scalar) {
+		typedef typename std::common_type<_T1, _T2>::type common_t;
+		return matrix<common_t, _M, _N, _Order>(mat) *= scalar;
+	}
+
+	template <typename _T1, typename _T2, std::size_t _M, std::size_t _N, typename _Order>
+	inline constexpr matrix<typename std::common_type<_T1, _T2>::type, _M, _N, _Order> operator * (_T1 scalar, matrix<_T2, _M, _N, _Order> const& mat) {
+		typedef typename std::common_type<_T1, _T2>::type common_t;
+		return matrix<common_t, _M, _N, _Order>(mat) *= scalar;
+	}
+
+	template <typename _T1, typename _T2, std::size_t _M, std::size_t _N, typename _Order>
+	inline constexpr matrix<typename std::common_type<_T1, _T2>::type, _M, _N, _Order> operator / (matrix<_T1, _M, _N, _Order> const& mat, _T2 scalar) {
+		typedef typename std::common_type<_T1, _T2>::type common_t;
+		return matrix<common_t, _M, _N, _Order>(mat) /= scalar;
+	}
+
+	/// (_N x _M) * (_M x _P): lhs has _M columns, rhs has _M rows. the result
+	/// takes the storage order of lhs.
+	template <typename _T1, typename _T2, std::size_t _M, std::size_t _N, std::size_t _P, typename _O1, typename _O2>
+	inline constexpr matrix<typename std::common_type<_T1, _T2>::type, _P, _N, _O1> operator * (matrix<_T1, _M, _N, _O1> const& lhs, matrix<_T2, _P, _M, _O2> const& rhs) {
+		typedef typename std::common_type<_T1, _T2>::type common_t;
+		matrix<common_t, _P, _N, _O1> result {};
+		for (std::size_t c = 0; c < _P; ++c)
+			for (std::size_t k = 0; k < _M; ++k)
+				for (std::size_t r = 0; r < _N; ++r)
+					result(r, c) += static_cast<common_t>(lhs(r, k)) * static_cast<common_t>(rhs(k, c));
+		return result;
+	}
+
+	template <typename _T1, typename _T2, std::size_t _M, std::size_t _N, typename _Order>
+	inline constexpr vector<typename std::common_type<_T1, _T2>::type, _N> operator * (matrix<_T1, _M, _N, _Order> const& mat, vector<_T2, _M> const& vec) {
+		typedef typename std::common_type<_T1, _T2>::type common_t;
+		vector<common_t, _N> result {};
+		for (std::size_t c = 0; c < _M; ++c)
+			for (std::size_t r = 0; r < _N; ++r)
+				result[r] += static_cast<common_t>(mat(r, c)) * static_cast<common_t>(vec[c]);
+		return result;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// precompiled instantiations (see math.cpp); square matrices in the default
+// storage order, with their views and products.
+
+#define _MATH_MATRIX_INSTANTIATIONS(_Extern, _T, _N) \
+	_Extern template struct linear_array<_T, _N>; \
+	_Extern template struct matrix_view<_T, _N, _N>; \
+	_Extern template struct internal::matrix_identity<matrix<_T, _N, _N>>; \
+	_Extern template struct internal::matrix_transforms<matrix<_T, _N, _N>>; \
+	_Extern template struct matrix<_T, _N, _N>; \
+	_Extern template matrix<_T, _N, _N> operator * (matrix<_T, _N, _N> const&, matrix<_T, _N, _N> const&); \
+	_Extern template vector<_T, _N> operator * (matrix<_T, _N, _N> const&, vector<_T, _N> const&);
+
+#if defined(MATH_EXTERN_TEMPLATES)
+namespace math {
+	_MATH_MATRIX_INSTANTIATIONS(extern, float, 2)
+	_MATH_MATRIX_INSTANTIATIONS(extern, float, 3)
+	_MATH_MATRIX_INSTANTIATIONS(extern, float, 4)
+	_MATH_MATRIX_INSTANTIATIONS(extern, double, 2)
+	_MATH_MATRIX_INSTANTIATIONS(extern, double, 3)
+	_MATH_MATRIX_INSTANTIATIONS(extern, double, 4)
 }
+#endif
 
 #endif // _MATH_MATRIX_HPP
\ No newline at end of file
@@ -0,0 +1,289 @@
+#ifndef _MATH_MEMORY_HPP
+#define _MATH_MEMORY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+
+#include "vector.hpp"
+
+namespace math {
+
+	namespace internal {
+
+		/// allocates bytes aligned to alignment (a power of two). the pointer
+		/// returned by operator new is stored just below the aligned block.
+		inline void* aligned_allocate(std::size_t bytes, std::size_t alignment) {
+			if (bytes > std::numeric_limits<std::size_t>::max() - alignment - sizeof(void*))
+				throw std::bad_alloc();
+
+			void* const base = ::operator new(bytes + alignment + sizeof(void*));
+			std::uintptr_t const first = reinterpret_cast<std::uintptr_t>(base) + sizeof(void*);
+			std::uintptr_t const aligned = (first + alignment - 1) & ~static_cast<std::uintptr_t>(alignment - 1);
+			reinterpret_cast<void**>(aligned)[-1] = base;
+			return reinterpret_cast<void*>(aligned);
+		}
+
+		inline void aligned_deallocate(void* ptr) noexcept {
+			if (ptr) ::operator delete(static_cast<void**>(ptr)[-1]);
+		}
+
+		template <typename _T>
+		constexpr _T round_up_pow2(_T value) noexcept {
+			_T result = 1;
+			while (result < value) result <<= 1;
+			return result;
+		}
+	}
+
+	/// default alignment for bulk buffers: one cache line, enough for any
+	/// vector register width.
+	constexpr std::size_t buffer_alignment = 64;
+
+	////////////////////////////////////////////////////////////////////////////////
+	// aligned allocator.
+
+	template <typename _T, std::size_t _Align = buffer_alignment>
+	struct aligned_allocator {
+		static_assert(_Align != 0 && (_Align & (_Align - 1)) == 0,
+			"aligned_allocator<T, Align> requires power of two alignment.");
+
+		typedef _T value_type;
+		typedef std::size_t size_type;
+		typedef std::ptrdiff_t difference_type;
+
+		template <typename _U>
+		struct rebind { typedef aligned_allocator<_U, _Align> other; };
+
+		aligned_allocator() noexcept = default;
+
+		template <typename _U>
+		aligned_allocator(aligned_allocator<_U, _Align> const&) noexcept {}
+
+		_T* allocate(size_type count) {
+			if (count > std::numeric_limits<size_type>::max() / sizeof(_T))
+				throw std::bad_alloc();
+			return static_cast<_T*>(internal::aligned_allocate(count * sizeof(_T), std::max(_Align, alignof(_T))));
+		}
+
+		void deallocate(_T* ptr, size_type) noexcept {
+			internal::aligned_deallocate(ptr);
+		}
+	};
+
+	template <typename _T1, typename _T2, std::size_t _Align>
+	bool operator == (aligned_allocator<_T1, _Align> const&, aligned_allocator<_T2, _Align> const&) noexcept { return true; }
+
+	template <typename _T1, typename _T2, std::size_t _Align>
+	bool operator != (aligned_allocator<_T1, _Align> const&, aligned_allocator<_T2, _Align> const&) noexcept { return false; }
+
+	template <typename _T> using aligned_vector = std::vector<_T, aligned_allocator<_T>>;
+
+	////////////////////////////////////////////////////////////////////////////////
+	// frame arena.
+
+	/// bump allocator for per-frame temporaries. allocation is a pointer bump
+	/// within the current block; nothing is freed individually, instead the
+	/// arena is rewound to a mark (or reset) once the temporaries are dead.
+	/// blocks are kept across resets, so a steady-state frame allocates no
+	/// memory from the system. an arena must only be used by one thread at a
+	/// time; local() returns one arena per thread.
+	struct frame_arena {
+
+		struct marker {
+			std::size_t block;
+			std::size_t offset;
+		};
+
+		/// rewinds the arena to where it was on construction.
+		struct scope {
+			explicit scope(frame_arena& arena) noexcept
+				: _arena(arena), _mark(arena.mark()) {}
+			~scope() { _arena.rewind(_mark); }
+
+			scope(scope const&) = delete;
+			scope& operator = (scope const&) = delete;
+
+		private:
+			frame_arena& _arena;
+			marker _mark;
+		};
+
+		////////////////////////////////////////////////////////////////////////////////
+		// constructors.
+
+		explicit frame_arena(std::size_t block_size = std::size_t(1) << 20) noexcept
+			: _block_size(block_size), _current(0), _offset(0) {}
+
+		frame_arena(frame_arena const&) = delete;
+		frame_arena& operator = (frame_arena const&) = delete;
+
+		~frame_arena() {
+			for (auto const& block : _blocks) internal::aligned_deallocate(block.data);
+		}
+
+		////////////////////////////////////////////////////////////////////////////////
+		// allocation.
+
+		void* allocate(std::size_t bytes, std::size_t alignment = buffer_alignment) {
+			for (; _current < _blocks.size(); ++_current, _offset = 0) {
+				std::size_t const offset = _blocks[_current].align(_offset, alignment);
+				if (offset <= _blocks[_current].size && bytes <= _blocks[_current].size - offset) {
+					_offset = offset + bytes;
+					return _blocks[_current].data + offset;
+				}
+			}
+
+			// no kept block fits. blocks start on buffer_alignment, so larger
+			// alignments need slack.
+			_block b;
+			b.size = std::max(_block_size, bytes + (alignment > buffer_alignment ? alignment : 0));
+			b.data = static_cast<char*>(internal::aligned_allocate(b.size, buffer_alignment));
+			_blocks.push_back(b);
+			_current = _blocks.size() - 1;
+
+			std::size_t const offset = b.align(0, alignment);
+			_offset = offset + bytes;
+			return b.data + offset;
+		}
+
+		template <typename _T>
+		_T* allocate(std::size_t count) {
+			if (count > std::numeric_limits<std::size_t>::max() / sizeof(_T))
+				throw std::bad_alloc();
+			return static_cast<_T*>(allocate(count * sizeof(_T), std::max(buffer_alignment, alignof(_T))));
+		}
+
+		marker mark() const noexcept {
+			return marker { _current, _offset };
+		}
+
+		void rewind(marker const& m) noexcept {
+			_current = m.block;
+			_offset = m.offset;
+		}
+
+		void reset() noexcept {
+			_current = 0;
+			_offset = 0;
+		}
+
+		/// bytes held from the system across all blocks.
+		std::size_t capacity() const noexcept {
+			std::size_t result = 0;
+			for (auto const& block : _blocks) result += block.size;
+			return result;
+		}
+
+		static frame_arena& local() {
+			static thread_local frame_arena arena;
+			return arena;
+		}
+
+	private:
+		struct _block {
+			char* data;
+			std::size_t size;
+
+			/// the first offset at or after from whose address is aligned.
+			std::size_t align(std::size_t from, std::size_t alignment) const noexcept {
+				std::uintptr_t const address = reinterpret_cast<std::uintptr_t>(data) + from;
+				return from + ((alignment - address % alignment) % alignment);
+			}
+		};
+
+		std::size_t _block_size;
+		std::vector<_block> _blocks;
+		std::size_t _current;
+		std::size_t _offset;
+	};
+
+	/// standard allocator drawing from a frame_arena; deallocation is a no-op.
+	template <typename _T>
+	struct arena_allocator {
+		typedef _T value_type;
+		typedef std::size_t size_type;
+		typedef std::ptrdiff_t difference_type;
+
+		arena_allocator() noexcept
+			: _arena(&frame_arena::local()) {}
+
+		explicit arena_allocator(frame_arena& arena) noexcept
+			: _arena(&arena) {}
+
+		template <typename _U>
+		arena_allocator(arena_allocator<_U> const& other) noexcept
+			: _arena(other.arena()) {}
+
+		_T* allocate(size_type count) { return _arena->allocate<_T>(count); }
+		void deallocate(_T*, size_type) noexcept {}
+
+		frame_arena* arena() const noexcept { return _arena; }
+
+	private:
+		frame_arena* _arena;
+	};
+
+	template <typename _T1, typename _T2>
+	bool operator == (arena_allocator<_T1> const& lhs, arena_allocator<_T2> const& rhs) noexcept { return lhs.arena() == rhs.arena(); }
+
+	template <typename _T1, typename _T2>
+	bool operator != (arena_allocator<_T1> const& lhs, arena_allocator<_T2> const& rhs) noexcept { return !(lhs == rhs); }
+
+	template <typename _T> using arena_vector = std::vector<_T, arena_allocator<_T>>;
+
+	////////////////////////////////////////////////////////////////////////////////
+	// layout policies.
+
+	/// vector padded and aligned to the next power of two of its size, so a
+	/// vector3<float> occupies 16 bytes and never straddles a cache line. it
+	/// converts to and from vector<_T, _N> and can be passed to any function
+	/// taking one.
+	///
+	/// the alignment can exceed alignof(std::max_align_t) (32 bytes for
+	/// vector3<double>), which c++14 std::allocator does not honour. buffers
+	/// must use aligned_vector or arena_vector; plain new is routed through
+	/// aligned_allocate by the class allocation functions below, and
+	/// placement new constructs in place as usual.
+	template <typename _T, std::size_t _N>
+	struct alignas(internal::round_up_pow2(sizeof(_T) * _N)) padded_vector : vector<_T, _N> {
+		static_assert(internal::round_up_pow2(sizeof(_T) * _N) <= buffer_alignment,
+			"padded_vector<T, N> must fit in one buffer_alignment block.");
+
+		using vector<_T, _N>::vector;
+
+		constexpr padded_vector() = default;
+		constexpr padded_vector(vector<_T, _N> const& other) noexcept
+			: vector<_T, _N>(other) {}
+
+		static void* operator new (std::size_t bytes) { return internal::aligned_allocate(bytes, alignof(padded_vector)); }
+		static void* operator new[] (std::size_t bytes) { return internal::aligned_allocate(bytes, alignof(padded_vector)); }
+		static void operator delete (void* ptr) noexcept { internal::aligned_deallocate(ptr); }
+		static void operator delete[] (void* ptr) noexcept { internal::aligned_deallocate(ptr); }
+
+		// the class allocation functions hide the global placement forms, so
+		// they are restated here for construction into existing storage.
+		static void* operator new (std::size_t, void* ptr) noexcept { return ptr; }
+		static void* operator new[] (std::size_t, void* ptr) noexcept { return ptr; }
+		static void operator delete (void*, void*) noexcept {}
+		static void operator delete[] (void*, void*) noexcept {}
+	};
+
+	template <typename _T> using padded_vector3 = padded_vector<_T, 3>;
+
+	/// selects the element type used for vector buffers, e.g.
+	/// aligned_vector<typename _Layout::template vector_type<float, 3>>.
+	struct packed_layout {
+		template <typename _T, std::size_t _N> using vector_type = vector<_T, _N>;
+	};
+
+	struct padded_layout {
+		template <typename _T, std::size_t _N> using vector_type = padded_vector<_T, _N>;
+	};
+}
+
+#endif // _MATH_MEMORY_HPP
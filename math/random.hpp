@@ -0,0 +1,333 @@
+#ifndef _MATH_RANDOM_HPP
+#define _MATH_RANDOM_HPP
+
+#include <cmath>
+#include <limits>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <algorithm>
+#include <type_traits>
+
+#include "angle.hpp"
+#include "vector.hpp"
+#include "matrix.hpp"
+#include "kernels.hpp"
+
+namespace math {
+
+	////////////////////////////////////////////////////////////////////////////////
+	// counter-based generator.
+	// philox4x32-10 (salmon et al., "parallel random numbers: as easy as 1, 2,
+	// 3"): a bijection of a 128-bit counter keyed by the seed. block k of a
+	// stream depends on nothing but (seed, stream, k), so any range of blocks
+	// can be generated on any thread, in any order, with identical results.
+
+	struct counter_rng {
+		typedef std::uint32_t result_type;
+
+		struct block {
+			std::uint32_t word[4];
+		};
+
+		////////////////////////////////////////////////////////////////////////////////
+		// constructors.
+
+		explicit counter_rng(std::uint64_t seed = 0, std::uint64_t stream = 0) noexcept
+			: _seed(seed), _stream(stream), _position(0), _word(4), _block() {}
+
+		////////////////////////////////////////////////////////////////////////////////
+		// counter access.
+
+		std::uint64_t seed() const noexcept { return _seed; }
+		std::uint64_t stream() const noexcept { return _stream; }
+
+		/// block index of the next block operator () or the fill functions use.
+		std::uint64_t position() const noexcept { return _position; }
+
+		void seek(std::uint64_t position) noexcept {
+			_position = position;
+			_word = 4;
+		}
+
+		void discard(std::uint64_t blocks) noexcept { seek(_position + blocks); }
+
+		/// the generator advanced to position, leaving this one untouched.
+		counter_rng at(std::uint64_t position) const noexcept {
+			counter_rng result(*this);
+			result.seek(position);
+			return result;
+		}
+
+		block generate(std::uint64_t index) const noexcept {
+			std::uint32_t c0 = static_cast<std::uint32_t>(index), c1 = static_cast<std::uint32_t>(index >> 32);
+			std::uint32_t c2 = static_cast<std::uint32_t>(_stream), c3 = static_cast<std::uint32_t>(_stream >> 32);
+			std::uint32_t k0 = static_cast<std::uint32_t>(_seed), k1 = static_cast<std::uint32_t>(_seed >> 32);
+
+			for (int round = 0; round < 10; ++round) {
+				std::uint64_t const p0 = std::uint64_t(0xD2511F53u) * c0;
+				std::uint64_t const p1 = std::uint64_t(0xCD9E8D57u) * c2;
+				std::uint32_t const n0 = static_cast<std::uint32_t>(p1 >> 32) ^ c1 ^ k0;
+				std::uint32_t const n2 = static_cast<std::uint32_t>(p0 >> 32) ^ c3 ^ k1;
+				c1 = static_cast<std::uint32_t>(p1);
+				c3 = static_cast<std::uint32_t>(p0);
+				c0 = n0;
+				c2 = n2;
+				k0 += 0x9E3779B9u;
+				k1 += 0xBB67AE85u;
+			}
+			return block { { c0, c1, c2, c3 } };
+		}
+
+		////////////////////////////////////////////////////////////////////////////////
+		// uniform random bit generator.
+
+		static constexpr result_type min() noexcept { return 0; }
+		static constexpr result_type max() noexcept { return std::numeric_limits<result_type>::max(); }
+
+		result_type operator ()() noexcept {
+			if (_word == 4) {
+				_block = generate(_position++);
+				_word = 0;
+			}
+			return _block.word[_word++];
+		}
+
+	private:
+		std::uint64_t _seed;
+		std::uint64_t _stream;
+		std::uint64_t _position;
+		unsigned _word;
+		block _block;
+	};
+
+	namespace internal {
+
+		constexpr std::size_t random_block = 64;
+
+		/// a value in [0, 1) from 32 random bits; float keeps the top 24.
+		template <typename _T>
+		inline _T uniform_unit(std::uint32_t bits) noexcept {
+			return std::is_same<_T, float>::value
+				? static_cast<_T>(bits >> 8) * _T(1.0 / 16777216.0)
+				: static_cast<_T>(bits) * _T(1.0 / 4294967296.0);
+		}
+
+		/// counter blocks first .. first + random_block - 1, one lane per block
+		/// and one array per word; the same rounds as counter_rng::generate,
+		/// laid out so every round vectorizes across the lanes.
+		inline void philox_block(counter_rng const& rng, std::uint64_t first, std::uint32_t (*word)[random_block]) noexcept {
+			std::uint32_t const c2 = static_cast<std::uint32_t>(rng.stream()), c3 = static_cast<std::uint32_t>(rng.stream() >> 32);
+			std::uint32_t k0 = static_cast<std::uint32_t>(rng.seed()), k1 = static_cast<std::uint32_t>(rng.seed() >> 32);
+
+			for (std::size_t i = 0; i < random_block; ++i) {
+				std::uint64_t const index = first + i;
+				word[0][i] = static_cast<std::uint32_t>(index);
+				word[1][i] = static_cast<std::uint32_t>(index >> 32);
+				word[2][i] = c2;
+				word[3][i] = c3;
+			}
+			for (int round = 0; round < 10; ++round) {
+				for (std::size_t i = 0; i < random_block; ++i) {
+					std::uint64_t const p0 = std::uint64_t(0xD2511F53u) * word[0][i];
+					std::uint64_t const p1 = std::uint64_t(0xCD9E8D57u) * word[2][i];
+					std::uint32_t const n0 = static_cast<std::uint32_t>(p1 >> 32) ^ word[1][i] ^ k0;
+					std::uint32_t const n2 = static_cast<std::uint32_t>(p0 >> 32) ^ word[3][i] ^ k1;
+					word[1][i] = static_cast<std::uint32_t>(p1);
+					word[3][i] = static_cast<std::uint32_t>(p0);
+					word[0][i] = n0;
+					word[2][i] = n2;
+				}
+				k0 += 0x9E3779B9u;
+				k1 += 0xBB67AE85u;
+			}
+		}
+
+		/// uniforms for the random_block samples starting at block index first:
+		/// sample i reads the four words of block first + i.
+		template <typename _T>
+		void uniform_block(counter_rng const& rng, std::uint64_t first, _T (*u)[random_block]) noexcept {
+			std::uint32_t word[4][random_block];
+			philox_block(rng, first, word);
+			for (std::size_t w = 0; w < 4; ++w)
+				for (std::size_t i = 0; i < random_block; ++i) u[w][i] = uniform_unit<_T>(word[w][i]);
+		}
+
+		/// drives fill over [first, last) in blocks, one counter block per
+		/// element, and advances rng past them.
+		template <typename _T, typename _ForwardIt, typename _Fill>
+		void fill_blocks(counter_rng& rng, _ForwardIt first, _ForwardIt last, _Fill fill) {
+			_T u[4][random_block];
+			while (first != last) {
+				std::size_t n = 0;
+				_ForwardIt block_last = first;
+				for (; n < random_block && block_last != last; ++n) ++block_last;
+
+				uniform_block(rng, rng.position(), u);
+				rng.discard(n);
+				fill(u, n, first);
+				first = block_last;
+			}
+		}
+
+		template <typename _T>
+		struct random_traits {
+			static_assert(std::is_floating_point<_T>::value,
+				"random sampling requires floating point type.");
+			static constexpr _T two_pi() noexcept { return kernel_traits<_T>::pi() * 2; }
+		};
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+	// batch sampling.
+	// each fills the range [first, last) with independent samples, using one
+	// counter block per element starting at rng.position(), and advances rng
+	// past them. to split a batch across threads, give each thread
+	// rng.at(start + offset) for its slice; the output is the same as a
+	// single call. sines and cosines use the branch-free kernels, and each
+	// block of 64 samples is evaluated with loops the compiler vectorizes.
+
+	/// angles uniform on [0, 2 pi) in the unit of the range's value_type.
+	template <typename _ForwardIt>
+	void fill_uniform_angles(counter_rng& rng, _ForwardIt first, _ForwardIt last) {
+		typedef typename std::iterator_traits<_ForwardIt>::value_type angle_t;
+		typedef typename angle_t::value_type value_t;
+		typedef typename angle_t::traits_type traits_t;
+		typedef typename std::common_type<value_t, float>::type common_t;
+
+		internal::fill_blocks<common_t>(rng, first, last, [](common_t (*u)[internal::random_block], std::size_t n, _ForwardIt out) {
+			common_t const full = static_cast<common_t>(traits_t::pi()) * 2;
+			for (std::size_t i = 0; i < n; ++i, ++out) *out = angle_t(static_cast<value_t>(u[0][i] * full));
+		});
+	}
+
+	/// unit vectors uniform on the circle.
+	template <typename _ForwardIt>
+	void fill_unit_circle(counter_rng& rng, _ForwardIt first, _ForwardIt last) {
+		typedef typename std::iterator_traits<_ForwardIt>::value_type vector_t;
+		typedef typename vector_t::value_type value_t;
+
+		internal::fill_blocks<value_t>(rng, first, last, [](value_t (*u)[internal::random_block], std::size_t n, _ForwardIt out) {
+			value_t s[internal::random_block], c[internal::random_block];
+			for (std::size_t i = 0; i < internal::random_block; ++i)
+				internal::fast_sincos(u[0][i] * internal::random_traits<value_t>::two_pi(), s[i], c[i]);
+			for (std::size_t i = 0; i < n; ++i, ++out) *out = vector_t { c[i], s[i] };
+		});
+	}
+
+	namespace internal {
+
+		/// archimedes: z uniform on [-1, 1] and the azimuth uniform give a
+		/// uniform point on the sphere, with one sincos and one sqrt. the sqrt
+		/// gets a loop of its own (its errno check is control flow), and each
+		/// output is written by a separate loop from local arrays, so every
+		/// other loop vectorizes without a runtime alias check.
+		template <typename _T>
+		void unit_sphere_block(_T const (*u)[random_block], _T* x, _T* y, _T* z) noexcept {
+			_T s[random_block], c[random_block], h[random_block], r[random_block];
+			for (std::size_t i = 0; i < random_block; ++i) {
+				fast_sincos(u[1][i] * random_traits<_T>::two_pi(), s[i], c[i]);
+				h[i] = _T(1) - _T(2) * u[0][i];
+				r[i] = _T(1) - h[i] * h[i];
+			}
+			for (std::size_t i = 0; i < random_block; ++i) r[i] = std::sqrt(r[i]);
+			for (std::size_t i = 0; i < random_block; ++i) x[i] = r[i] * c[i];
+			for (std::size_t i = 0; i < random_block; ++i) y[i] = r[i] * s[i];
+			for (std::size_t i = 0; i < random_block; ++i) z[i] = h[i];
+		}
+
+		/// shoemake: a unit quaternion (x, y, z, w) uniform over rotations.
+		template <typename _T>
+		void unit_quaternion_block(_T const (*u)[random_block], _T* x, _T* y, _T* z, _T* w) noexcept {
+			_T s1[random_block], c1[random_block], s2[random_block], c2[random_block], a[random_block], b[random_block];
+			for (std::size_t i = 0; i < random_block; ++i) {
+				fast_sincos(u[1][i] * random_traits<_T>::two_pi(), s1[i], c1[i]);
+				fast_sincos(u[2][i] * random_traits<_T>::two_pi(), s2[i], c2[i]);
+			}
+			for (std::size_t i = 0; i < random_block; ++i) {
+				a[i] = std::sqrt(_T(1) - u[0][i]);
+				b[i] = std::sqrt(u[0][i]);
+			}
+			for (std::size_t i = 0; i < random_block; ++i) x[i] = a[i] * s1[i];
+			for (std::size_t i = 0; i < random_block; ++i) y[i] = a[i] * c1[i];
+			for (std::size_t i = 0; i < random_block; ++i) z[i] = b[i] * s2[i];
+			for (std::size_t i = 0; i < random_block; ++i) w[i] = b[i] * c2[i];
+		}
+
+		/// writes the rotation of unit quaternion (x, y, z, w) to the upper
+		/// 3x3 block of m.
+		template <typename _Matrix, typename _T>
+		void quaternion_rotation(_Matrix& m, _T x, _T y, _T z, _T w) noexcept {
+			m(0, 0) = _T(1) - _T(2) * (y * y + z * z);
+			m(0, 1) = _T(2) * (x * y - z * w);
+			m(0, 2) = _T(2) * (x * z + y * w);
+			m(1, 0) = _T(2) * (x * y + z * w);
+			m(1, 1) = _T(1) - _T(2) * (x * x + z * z);
+			m(1, 2) = _T(2) * (y * z - x * w);
+			m(2, 0) = _T(2) * (x * z - y * w);
+			m(2, 1) = _T(2) * (y * z + x * w);
+			m(2, 2) = _T(1) - _T(2) * (x * x + y * y);
+		}
+	}
+
+	/// unit vectors uniform on the sphere.
+	template <typename _ForwardIt>
+	void fill_unit_sphere(counter_rng& rng, _ForwardIt first, _ForwardIt last) {
+		typedef typename std::iterator_traits<_ForwardIt>::value_type vector_t;
+		typedef typename vector_t::value_type value_t;
+
+		internal::fill_blocks<value_t>(rng, first, last, [](value_t (*u)[internal::random_block], std::size_t n, _ForwardIt out) {
+			value_t x[internal::random_block], y[internal::random_block], z[internal::random_block];
+			internal::unit_sphere_block(u, x, y, z);
+			for (std::size_t i = 0; i < n; ++i, ++out) *out = vector_t { x[i], y[i], z[i] };
+		});
+	}
+
+	/// unit vectors uniform on the sphere, one array per component.
+	template <typename _T>
+	void fill_unit_sphere(counter_rng& rng, _T* x, _T* y, _T* z, std::size_t count) {
+		_T u[4][internal::random_block], bx[internal::random_block], by[internal::random_block], bz[internal::random_block];
+		for (std::size_t first = 0; first < count; first += internal::random_block) {
+			std::size_t const n = std::min(internal::random_block, count - first);
+			internal::uniform_block(rng, rng.position(), u);
+			rng.discard(n);
+			internal::unit_sphere_block(u, bx, by, bz);
+			std::copy(bx, bx + n, x + first);
+			std::copy(by, by + n, y + first);
+			std::copy(bz, bz + n, z + first);
+		}
+	}
+
+	/// unit quaternions uniform over rotations as vector4 (x, y, z, w).
+	template <typename _ForwardIt>
+	void fill_unit_quaternions(counter_rng& rng, _ForwardIt first, _ForwardIt last) {
+		typedef typename std::iterator_traits<_ForwardIt>::value_type vector_t;
+		typedef typename vector_t::value_type value_t;
+
+		internal::fill_blocks<value_t>(rng, first, last, [](value_t (*u)[internal::random_block], std::size_t n, _ForwardIt out) {
+			value_t x[internal::random_block], y[internal::random_block], z[internal::random_block], w[internal::random_block];
+			internal::unit_quaternion_block(u, x, y, z, w);
+			for (std::size_t i = 0; i < n; ++i, ++out) *out = vector_t { x[i], y[i], z[i], w[i] };
+		});
+	}
+
+	/// rotation matrices uniform over rotations; the range may hold 3x3 or
+	/// 4x4 matrices (the latter get the identity outside the upper 3x3 block).
+	template <typename _ForwardIt>
+	void fill_rotations(counter_rng& rng, _ForwardIt first, _ForwardIt last) {
+		typedef typename std::iterator_traits<_ForwardIt>::value_type matrix_t;
+		typedef typename matrix_t::value_type value_t;
+
+		internal::fill_blocks<value_t>(rng, first, last, [](value_t (*u)[internal::random_block], std::size_t n, _ForwardIt out) {
+			value_t x[internal::random_block], y[internal::random_block], z[internal::random_block], w[internal::random_block];
+			internal::unit_quaternion_block(u, x, y, z, w);
+			for (std::size_t i = 0; i < n; ++i, ++out) {
+				matrix_t m = matrix_t::identity();
+				internal::quaternion_rotation(m, x[i], y[i], z[i], w[i]);
+				*out = m;
+			}
+		});
+	}
+}
+
+#endif // _MATH_RANDOM_HPP
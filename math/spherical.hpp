@@ -0,0 +1,139 @@
+#ifndef _MATH_SPHERICAL_HPP
+#define _MATH_SPHERICAL_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+#include "angle.hpp"
+#include "vector.hpp"
+#include "kernels.hpp"
+
+namespace math {
+
+	////////////////////////////////////////////////////////////////////////////////
+	// batch spherical <-> cartesian conversion.
+	// theta is the polar angle measured from +z and phi the azimuth in the
+	// xy-plane, matching the vector3(theta, phi, radius) constructor. angles may
+	// use any traits type; each sin/cos pair is evaluated once per point.
+	// points are read spherical_block at a time into local arrays, zero padded,
+	// and the kernels run over whole blocks: the constant trip count is what
+	// lets the compiler vectorize the sin/cos and atan2 loops at -O2. square
+	// roots keep loops of their own and stay scalar, as their errno check is
+	// control flow.
+
+	namespace internal {
+
+		constexpr std::size_t spherical_block = 64;
+
+		template <typename _T>
+		inline void spherical_pad(_T* values, std::size_t n) noexcept {
+			for (std::size_t i = n; i < spherical_block; ++i) values[i] = _T(0);
+		}
+
+		template <typename _T>
+		inline void spherical_sincos(_T const* x, _T* s, _T* c) noexcept {
+			for (std::size_t i = 0; i < spherical_block; ++i) fast_sincos(x[i], s[i], c[i]);
+		}
+	}
+
+	template <typename _InputIt1, typename _InputIt2, typename _InputIt3, typename _OutputIt>
+	_OutputIt spherical_to_cartesian(
+		_InputIt1 theta_first, _InputIt1 theta_last,
+		_InputIt2 phi_first, _InputIt3 radius_first, _OutputIt d_first) {
+			typedef typename std::iterator_traits<_InputIt1>::value_type angle_t;
+			typedef typename std::common_type<typename angle_t::value_type, float>::type common_t;
+			std::size_t const block = internal::spherical_block;
+
+			common_t theta[block], phi[block], radius[block];
+			common_t sin_theta[block], cos_theta[block], sin_phi[block], cos_phi[block];
+			while (theta_first != theta_last) {
+				std::size_t n = 0;
+				for (; n < block && theta_first != theta_last; ++n, ++theta_first, ++phi_first, ++radius_first) {
+					theta[n] = radians<common_t>(*theta_first).value();
+					phi[n] = radians<common_t>(*phi_first).value();
+					radius[n] = static_cast<common_t>(*radius_first);
+				}
+				internal::spherical_pad(theta, n);
+				internal::spherical_pad(phi, n);
+				internal::spherical_sincos(theta, sin_theta, cos_theta);
+				internal::spherical_sincos(phi, sin_phi, cos_phi);
+
+				for (std::size_t i = 0; i < n; ++i, ++d_first) {
+					common_t const rho = radius[i] * sin_theta[i];
+					*d_first = vector3<common_t> { rho * cos_phi[i], rho * sin_phi[i], radius[i] * cos_theta[i] };
+				}
+			}
+
+			return d_first;
+		}
+
+	template <typename _InputIt1, typename _InputIt2, typename _OutputIt>
+	_OutputIt spherical_to_cartesian(
+		_InputIt1 theta_first, _InputIt1 theta_last,
+		_InputIt2 phi_first, _OutputIt d_first) {
+			typedef typename std::iterator_traits<_InputIt1>::value_type angle_t;
+			typedef typename std::common_type<typename angle_t::value_type, float>::type common_t;
+			std::size_t const block = internal::spherical_block;
+
+			common_t theta[block], phi[block];
+			common_t sin_theta[block], cos_theta[block], sin_phi[block], cos_phi[block];
+			while (theta_first != theta_last) {
+				std::size_t n = 0;
+				for (; n < block && theta_first != theta_last; ++n, ++theta_first, ++phi_first) {
+					theta[n] = radians<common_t>(*theta_first).value();
+					phi[n] = radians<common_t>(*phi_first).value();
+				}
+				internal::spherical_pad(theta, n);
+				internal::spherical_pad(phi, n);
+				internal::spherical_sincos(theta, sin_theta, cos_theta);
+				internal::spherical_sincos(phi, sin_phi, cos_phi);
+
+				for (std::size_t i = 0; i < n; ++i, ++d_first)
+					*d_first = vector3<common_t> { sin_theta[i] * cos_phi[i], sin_theta[i] * sin_phi[i], cos_theta[i] };
+			}
+
+			return d_first;
+		}
+
+	/// writes theta, phi and radius for every point in [first, last). theta and
+	/// phi are produced as radians and converted on assignment, so the outputs
+	/// may hold any angle unit. the radius is not rescaled (see fast_hypot).
+	template <typename _InputIt, typename _OutputIt1, typename _OutputIt2, typename _OutputIt3>
+	void cartesian_to_spherical(
+		_InputIt first, _InputIt last,
+		_OutputIt1 theta_first, _OutputIt2 phi_first, _OutputIt3 radius_first) {
+			typedef typename std::iterator_traits<_InputIt>::value_type vector_t;
+			typedef typename std::common_type<typename vector_t::value_type, float>::type common_t;
+			std::size_t const block = internal::spherical_block;
+
+			common_t x[block], y[block], z[block], rho[block], radius[block], theta[block], phi[block];
+			while (first != last) {
+				std::size_t n = 0;
+				for (; n < block && first != last; ++n, ++first) {
+					x[n] = static_cast<common_t>((*first)[0]);
+					y[n] = static_cast<common_t>((*first)[1]);
+					z[n] = static_cast<common_t>((*first)[2]);
+				}
+				internal::spherical_pad(x, n);
+				internal::spherical_pad(y, n);
+				internal::spherical_pad(z, n);
+
+				for (std::size_t i = 0; i < block; ++i) rho[i] = internal::fast_hypot(x[i], y[i]);
+				for (std::size_t i = 0; i < block; ++i) radius[i] = internal::fast_hypot(rho[i], z[i]);
+
+				// atan2(rho, z) rather than acos(z / r): no division by the radius
+				// and no loss of precision near the poles.
+				for (std::size_t i = 0; i < block; ++i) theta[i] = internal::fast_atan2(rho[i], z[i]);
+				for (std::size_t i = 0; i < block; ++i) phi[i] = internal::fast_atan2(y[i], x[i]);
+
+				for (std::size_t i = 0; i < n; ++i, ++theta_first, ++phi_first, ++radius_first) {
+					*theta_first = radians<common_t> { theta[i] };
+					*phi_first = radians<common_t> { phi[i] };
+					*radius_first = radius[i];
+				}
+			}
+		}
+}
+
+#endif // _MATH_SPHERICAL_HPP
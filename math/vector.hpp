@@ -2,6 +2,7 @@
 #define _MATH_VECTOR_HPP
 
 #include <cmath>
+#include <cassert>
 #include <numeric>
 #include <iterator>
 #include <algorithm>
@@ -23,8 +24,8 @@ namespace math {
 			////////////////////////////////////////////////////////////////////////////////
 			// subscript operators.
 
-			_T& operator [](std::size_t index) noexcept { return _data[index]; }
-			_T const& operator [](std::size_t index) const noexcept { return _data[index]; }
+			constexpr _T& operator [](std::size_t index) noexcept { return assert(index < _N), _data[index]; }
+			constexpr _T const& operator [](std::size_t index) const noexcept { return assert(index < _N), _data[index]; }
 		};
 
 		template <typename _T>
@@ -36,7 +37,7 @@ namespace math {
 
 			constexpr vector_base() = default;
 
-			vector_base(_T x, _T y)
+			constexpr vector_base(_T x, _T y)
 				: x(x), y(y) {}
 
 			vector_base(radians<_T> const& theta, _T radius = static_cast<_T>(1))
@@ -45,13 +46,17 @@ namespace math {
 
 			////////////////////////////////////////////////////////////////////////////////
 			// subscript operators.
+			// an index past the last member would otherwise read it silently,
+			// so debug builds assert.
 
-			_T& operator [](std::size_t index) noexcept {
-				return *(reinterpret_cast<_T*>(this) + index);
+			constexpr _T& operator [](std::size_t index) noexcept {
+				assert(index < 2);
+				return index == 0 ? x : y;
 			}
 
-			_T const& operator [](std::size_t index) const noexcept {
-				return *(reinterpret_cast<_T const*>(this) + index);
+			constexpr _T const& operator [](std::size_t index) const noexcept {
+				assert(index < 2);
+				return index == 0 ? x : y;
 			}
 		};
 
@@ -64,23 +69,29 @@ namespace math {
 
 			constexpr vector_base() = default;
 
-			vector_base(_T x, _T y, _T z = static_cast<_T>(1))
+			constexpr vector_base(_T x, _T y, _T z = static_cast<_T>(1))
 				: x(x), y(y), z(z) {}
 
 			vector_base(radians<_T> const& theta, radians<_T> const& phi, _T radius = static_cast<_T>(1))
-				: x(radius * std::sin(theta.value()) * std::cos(phi.value()))
-				, y(radius * std::sin(theta.value()) * std::sin(phi.value()))
-				, z(radius * std::cos(theta.value())) {}
+				: vector_base(_cylindrical(radius * std::sin(theta.value()), phi, radius * std::cos(theta.value()))) {}
 
 			////////////////////////////////////////////////////////////////////////////////
 			// subscript operators.
 
-			_T& operator [](std::size_t index) noexcept {
-				return *(reinterpret_cast<_T*>(this) + index);
+			constexpr _T& operator [](std::size_t index) noexcept {
+				assert(index < 3);
+				return index == 0 ? x : index == 1 ? y : z;
 			}
 
-			_T const& operator [](std::size_t index) const noexcept {
-				return *(reinterpret_cast<_T const*>(this) + index);
+			constexpr _T const& operator [](std::size_t index) const noexcept {
+				assert(index < 3);
+				return index == 0 ? x : index == 1 ? y : z;
+			}
+
+		private:
+			// rho = radius * sin(theta), the distance from the z-axis.
+			static vector_base _cylindrical(_T rho, radians<_T> const& phi, _T z) noexcept {
+				return vector_base(rho * std::cos(phi.value()), rho * std::sin(phi.value()), z);
 			}
 		};
 
@@ -93,25 +104,27 @@ namespace math {
 
 			constexpr vector_base() = default;
 
-			vector_base(_T x, _T y, _T z, _T w = static_cast<_T>(1))
+			constexpr vector_base(_T x, _T y, _T z, _T w = static_cast<_T>(1))
 				: x(x), y(y), z(z), w(w) {}
 
 			////////////////////////////////////////////////////////////////////////////////
 			// subscript operators.
 
-			_T& operator [](std::size_t index) noexcept {
-				return *(reinterpret_cast<_T*>(this) + index);
+			constexpr _T& operator [](std::size_t index) noexcept {
+				assert(index < 4);
+				return index == 0 ? x : index == 1 ? y : index == 2 ? z : w;
 			}
 
-			_T const& operator [](std::size_t index) const noexcept {
-				return *(reinterpret_cast<_T const*>(this) + index);
+			constexpr _T const& operator [](std::size_t index) const noexcept {
+				assert(index < 4);
+				return index == 0 ? x : index == 1 ? y : index == 2 ? z : w;
 			}
 		};
 	}
 
 	template <typename _T, std::size_t _N>
 	struct vector : public internal::vector_base<_T, _N> {
-		static_assert(std::is_arithmetic<_T>::value,
+		static_assert(math::is_arithmetic<_T>::value,
 			"vector<T, N> requires arithmetic type.");
 
 		////////////////////////////////////////////////////////////////////////////////
@@ -137,38 +150,36 @@ namespace math {
 		////////////////////////////////////////////////////////////////////////////////
 		// unary arithmetic operators.
 
-		vector operator +() const noexcept {
+		constexpr vector operator +() const noexcept {
 			return *this;
 		}
 
-		vector operator -() const noexcept {
-			return -1 * (*this);
+		constexpr vector operator -() const noexcept {
+			vector result {};
+			for (size_type i = 0; i < _N; ++i) result[i] = -(*this)[i];
+			return result;
 		}
 
 		////////////////////////////////////////////////////////////////////////////////
 		// compound arithmetic operators.
 
-		vector& operator += (vector const& other) noexcept {
-			std::transform(this->begin(), this->end(), other.begin(),
-				this->begin(), std::plus<_T>());
+		constexpr vector& operator += (vector const& other) noexcept {
+			for (size_type i = 0; i < _N; ++i) (*this)[i] += other[i];
 			return *this;
 		}
 
-		vector& operator -= (vector const& other) noexcept {
-			std::transform(this->begin(), this->end(), other.begin(),
-				this->begin(), std::minus<_T>());
+		constexpr vector& operator -= (vector const& other) noexcept {
+			for (size_type i = 0; i < _N; ++i) (*this)[i] -= other[i];
 			return *this;
 		}
 
-		vector& operator *= (value_type scalar) noexcept {
-			std::transform(this->begin(), this->end(), this->begin(),
-				std::bind(std::multiplies<_T>(), std::placeholders::_1, scalar));
+		constexpr vector& operator *= (value_type scalar) noexcept {
+			for (size_type i = 0; i < _N; ++i) (*this)[i] *= scalar;
 			return *this;
 		}
 
-		vector& operator /= (value_type scalar) noexcept {
-			std::transform(this->begin(), this->end(), this->begin(),
-				std::bind(std::divides<_T>(), std::placeholders::_1, scalar));
+		constexpr vector& operator /= (value_type scalar) noexcept {
+			for (size_type i = 0; i < _N; ++i) (*this)[i] /= scalar;
 			return *this;
 		}
 
@@ -176,49 +187,50 @@ namespace math {
 		// methods.
 
 		typename std::common_type<_T, float>::type length() const noexcept{
-			return std::sqrt(this->length_sqr());
+			using std::sqrt;
+			return sqrt(this->length_sqr());
 		}
 
-		typename std::common_type<_T, float>::type length_sqr() const noexcept {
+		constexpr typename std::common_type<_T, float>::type length_sqr() const noexcept {
 			return dot_product(*this, *this);
 		}
 
 		////////////////////////////////////////////////////////////////////////////////
 		// iteration.
 
-		iterator begin() noexcept { return std::addressof((*this)[0]); }
-		iterator end() noexcept { return std::addressof((*this)[_N]); }
+		iterator begin() noexcept { return &(*this)[0]; }
+		iterator end() noexcept { return &(*this)[0] + _N; }
 
-		const_iterator begin() const noexcept { return std::addressof((*this)[0]); }
-		const_iterator end() const noexcept { return std::addressof((*this)[_N]); }
+		const_iterator begin() const noexcept { return &(*this)[0]; }
+		const_iterator end() const noexcept { return &(*this)[0] + _N; }
 
-		const_iterator cbegin() const noexcept { return std::addressof((*this)[0]); }
-		const_iterator cend() const noexcept { return std::addressof((*this)[_N]); }
+		const_iterator cbegin() const noexcept { return &(*this)[0]; }
+		const_iterator cend() const noexcept { return &(*this)[0] + _N; }
 
-		reverse_iterator rbegin() noexcept { return this->end(); }
-		reverse_iterator rend() noexcept { return this->begin(); }
+		reverse_iterator rbegin() noexcept { return reverse_iterator(this->end()); }
+		reverse_iterator rend() noexcept { return reverse_iterator(this->begin()); }
 
-		const_reverse_iterator rbegin() const noexcept { return this->end(); }
-		const_reverse_iterator rend() const noexcept { return this->begin(); }
+		const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(this->end()); }
+		const_reverse_iterator rend() const noexcept { return const_reverse_iterator(this->begin()); }
 
-		const_reverse_iterator crbegin() const noexcept { return this->cend(); }
-		const_reverse_iterator crend() const noexcept { return this->cbegin(); }
+		const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator(this->cend()); }
+		const_reverse_iterator crend() const noexcept { return const_reverse_iterator(this->cbegin()); }
 
 		////////////////////////////////////////////////////////////////////////////////
 		// conversion operators.
 
 		template <typename _T2>
-		operator vector<_T2, _N>() const noexcept {
-			vector<_T2, _N> result;
-			std::copy(this->begin(), this->end(), result.begin());
+		constexpr operator vector<_T2, _N>() const noexcept {
+			vector<_T2, _N> result {};
+			for (size_type i = 0; i < _N; ++i) result[i] = static_cast<_T2>((*this)[i]);
 			return result;
 		}
 
 		template <typename _T2>
-		operator vector<_T2, _N + 1>() const noexcept {
-			vector<_T2, _N + 1> result;
-			std::copy(this->begin(), this->end(), result.begin());
-			*(result.end() - 1) = static_cast<_T2>(1);
+		constexpr operator vector<_T2, _N + 1>() const noexcept {
+			vector<_T2, _N + 1> result {};
+			for (size_type i = 0; i < _N; ++i) result[i] = static_cast<_T2>((*this)[i]);
+			result[_N] = static_cast<_T2>(1);
 			return result;
 		}
 	};
@@ -232,18 +244,14 @@ namespace math {
 	// equality operators.
 
 	template <typename _T1, typename _T2, std::size_t _N>
-	bool operator == (vector<_T1, _N> const& lhs, vector<_T2, _N> const& rhs) {
-		auto first1 = lhs.begin();
-		auto first2 = rhs.begin();
-		auto last1 = lhs.end();
-
-		for (; first1 != last1; ++first1, ++first2)
-			if (!(*first1 == *first2)) return false;
+	constexpr bool operator == (vector<_T1, _N> const& lhs, vector<_T2, _N> const& rhs) {
+		for (std::size_t i = 0; i < _N; ++i)
+			if (!(lhs[i] == rhs[i])) return false;
 		return true;
 	}
 
 	template <typename _T1, typename _T2, std::size_t _N>
-	bool operator != (vector<_T1, _N> const& lhs, vector<_T2, _N> const& rhs) {
+	constexpr bool operator != (vector<_T1, _N> const& lhs, vector<_T2, _N> const& rhs) {
 		return !(lhs == rhs);
 	}
 
@@ -251,31 +259,31 @@ namespace math {
 	// binary arithmetic operators.
 
 	template <typename _T1, typename _T2, std::size_t _N>
-	inline vector<typename std::common_type<_T1, _T2>::type, _N> operator + (vector<_T1, _N> const& lhs, vector<_T2, _N> const& rhs) {
+	inline constexpr vector<typename std::common_type<_T1, _T2>::type, _N> operator + (vector<_T1, _N> const& lhs, vector<_T2, _N> const& rhs) {
 		typedef typename std::common_type<_T1, _T2>::type common_t;
 		return vector<common_t, _N>(lhs) += rhs;
 	}
 
 	template <typename _T1, typename _T2, std::size_t _N>
-	inline vector<typename std::common_type<_T1, _T2>::type, _N> operator - (vector<_T1, _N> const& lhs, vector<_T2, _N> const& rhs) {
+	inline constexpr vector<typename std::common_type<_T1, _T2>::type, _N> operator - (vector<_T1, _N> const& lhs, vector<_T2, _N> const& rhs) {
 		typedef typename std::common_type<_T1, _T2>::type common_t;
 		return vector<common_t, _N>(lhs) -= rhs;
 	}
 
 	template <typename _T1, typename _T2, std::size_t _N>
-	inline vector<typename std::common_type<_T1, _T2>::type, _N> operator * (vector<_T1, _N> const& vec, _T2 scalar) {
+	inline constexpr vector<typename std::common_type<_T1, _T2>::type, _N> operator * (vector<_T1, _N> const& vec, _T2 scalar) {
 		typedef typename std::common_type<_T1, _T2>::type common_t;
 		return vector<common_t, _N>(vec) *= scalar;
 	}
 
 	template <typename _T1, typename _T2, std::size_t _N>
-	inline vector<typename std::common_type<_T1, _T2>::type, _N> operator * (_T1 scalar, vector<_T2, _N> const& vec) {
+	inline constexpr vector<typename std::common_type<_T1, _T2>::type, _N> operator * (_T1 scalar, vector<_T2, _N> const& vec) {
 		typedef typename std::common_type<_T1, _T2>::type common_t;
 		return vector<common_t, _N>(vec) *= scalar;
 	}
 
 	template <typename _T1, typename _T2, std::size_t _N>
-	inline vector<typename std::common_type<_T1, _T2>::type, _N> operator / (vector<_T1, _N> const& vec, _T2 scalar) {
+	inline constexpr vector<typename std::common_type<_T1, _T2>::type, _N> operator / (vector<_T1, _N> const& vec, _T2 scalar) {
 		typedef typename std::common_type<_T1, _T2>::type common_t;
 		return vector<common_t, _N>(vec) /= scalar;
 	}
@@ -284,7 +292,7 @@ namespace math {
 	// functions.
 
 	template <typename _T1, typename _T2>
-	vector<typename std::common_type<_T1, _T2>::type, 3> cross_product(vector<_T1, 3> const& lhs, vector<_T2, 3> const& rhs) {
+	constexpr vector<typename std::common_type<_T1, _T2>::type, 3> cross_product(vector<_T1, 3> const& lhs, vector<_T2, 3> const& rhs) {
 		typedef typename std::common_type<_T1, _T2>::type common_t;
 		return vector<common_t, 3> {
 			lhs.y * rhs.z - lhs.z * rhs.y,
@@ -293,18 +301,21 @@ namespace math {
 	}
 
 	template <typename _T1, typename _T2, std::size_t _N>
-	typename std::common_type<_T1, _T2, float>::type dot_product(vector<_T1, _N> const& lhs, vector<_T2, _N> const& rhs) {
+	constexpr typename std::common_type<_T1, _T2, float>::type dot_product(vector<_T1, _N> const& lhs, vector<_T2, _N> const& rhs) {
 		typedef typename std::common_type<_T1, _T2, float>::type common_t;
-		return std::inner_product(lhs.begin(), lhs.end(), rhs.begin(), static_cast<common_t>(0));
+		common_t result = static_cast<common_t>(0);
+		for (std::size_t i = 0; i < _N; ++i)
+			result += static_cast<common_t>(lhs[i]) * static_cast<common_t>(rhs[i]);
+		return result;
 	}
 
  	template <typename _T1, typename _T2, std::size_t _N>
- 	vector<typename std::common_type<_T1, _T2, float>::type, _N> projection(vector<_T1, _N> const& vec, vector<_T2, _N> const& n) {
+ 	constexpr vector<typename std::common_type<_T1, _T2, float>::type, _N> projection(vector<_T1, _N> const& vec, vector<_T2, _N> const& n) {
 		return dot_product(vec, n) / dot_product(n, n) * n;
 	}
 
 	template <typename _T1, typename _T2, std::size_t _N>
- 	vector<typename std::common_type<_T1, _T2, float>::type, _N> reflection(vector<_T1, _N> const& vec, vector<_T2, _N> const& n) {
+ 	constexpr vector<typename std::common_type<_T1, _T2, float>::type, _N> reflection(vector<_T1, _N> const& vec, vector<_T2, _N> const& n) {
 		typedef typename std::common_type<_T1, _T2, float>::type common_t;
 		return vec - static_cast<common_t>(2) * projection(vec, n);
 	}
@@ -320,31 +331,33 @@ namespace math {
 	}
 
 
-	template <typename _T, std::size_t _N> vector<_T, _N> const& min(vector<_T, _N> const& vec) { return vec; }
-	template <typename _T, std::size_t _N> vector<_T, _N> const& max(vector<_T, _N> const& vec) { return vec; }
+	template <typename _T, std::size_t _N> constexpr vector<_T, _N> const& min(vector<_T, _N> const& vec) { return vec; }
+	template <typename _T, std::size_t _N> constexpr vector<_T, _N> const& max(vector<_T, _N> const& vec) { return vec; }
 
 	template <typename _T1, typename _T2, std::size_t _N>
-	vector<typename std::common_type<_T1, _T2>::type, _N> min(
+	constexpr vector<typename std::common_type<_T1, _T2>::type, _N> min(
 		vector<_T1, _N> const& lhs,
 		vector<_T2, _N> const& rhs) {
-			vector<typename std::common_type<_T1, _T2>::type, _N> result;
-			std::transform(lhs.begin(), lhs.end(), rhs.begin(), result.begin(),
-				[](_T1 const& a, _T2 const& b) { return std::min(a, b); });
+			typedef typename std::common_type<_T1, _T2>::type common_t;
+			vector<common_t, _N> result {};
+			for (std::size_t i = 0; i < _N; ++i)
+				result[i] = rhs[i] < lhs[i] ? static_cast<common_t>(rhs[i]) : static_cast<common_t>(lhs[i]);
 			return result;
 		}
 
 	template <typename _T1, typename _T2, std::size_t _N>
-	vector<typename std::common_type<_T1, _T2>::type, _N> max(
+	constexpr vector<typename std::common_type<_T1, _T2>::type, _N> max(
 		vector<_T1, _N> const& lhs,
 		vector<_T2, _N> const& rhs) {
-			vector<typename std::common_type<_T1, _T2>::type, _N> result;
-			std::transform(lhs.begin(), lhs.end(), rhs.begin(), result.begin(),
-				[](_T1 const& a, _T2 const& b) { return std::max(a, b); });
+			typedef typename std::common_type<_T1, _T2>::type common_t;
+			vector<common_t, _N> result {};
+			for (std::size_t i = 0; i < _N; ++i)
+				result[i] = lhs[i] < rhs[i] ? static_cast<common_t>(rhs[i]) : static_cast<common_t>(lhs[i]);
 			return result;
 		}
 
 	template <typename _T1, typename _T2, typename... _Ts, std::size_t _N>
-	vector<typename std::common_type<_T1, _T2, _Ts...>::type, _N> min(
+	constexpr vector<typename std::common_type<_T1, _T2, _Ts...>::type, _N> min(
 		vector<_T1, _N> const& v1,
 		vector<_T2, _N> const& v2,
 		vector<_Ts, _N> const&... vs) {
@@ -352,7 +365,7 @@ namespace math {
 		}
 
 	template <typename _T1, typename _T2, typename... _Ts, std::size_t _N>
-	vector<typename std::common_type<_T1, _T2, _Ts...>::type, _N> max(
+	constexpr vector<typename std::common_type<_T1, _T2, _Ts...>::type, _N> max(
 		vector<_T1, _N> const& v1,
 		vector<_T2, _N> const& v2,
 		vector<_Ts, _N> const&... vs) {
@@ -369,5 +382,22 @@ namespace math {
 	}
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// precompiled instantiations (see math.cpp).
+
+#define _MATH_VECTOR_INSTANTIATIONS(_Extern, _T, _N) \
+	_Extern template struct internal::vector_base<_T, _N>; \
+	_Extern template struct vector<_T, _N>;
+
+#if defined(MATH_EXTERN_TEMPLATES)
+namespace math {
+	_MATH_VECTOR_INSTANTIATIONS(extern, float, 2)
+	_MATH_VECTOR_INSTANTIATIONS(extern, float, 3)
+	_MATH_VECTOR_INSTANTIATIONS(extern, float, 4)
+	_MATH_VECTOR_INSTANTIATIONS(extern, double, 2)
+	_MATH_VECTOR_INSTANTIATIONS(extern, double, 3)
+	_MATH_VECTOR_INSTANTIATIONS(extern, double, 4)
+}
+#endif
 
 #endif  // _MATH_VECTOR_HPP
\ No newline at end of file
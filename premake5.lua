@@ -2,10 +2,29 @@ solution "math"
 	configurations { "debug", "release" }
 
 	configuration "gmake"
-		buildoptions { "-std=c++11", "-Wall", "-Wextra" }
+		buildoptions { "-std=c++14", "-Wall", "-Wextra", "-pthread" }
+		linkoptions { "-pthread" }
 
 	-- visual studio stuff here.
 
+	-- the precompiled float and double instantiations (math/math.cpp).
+	project "math"
+		kind "StaticLib"
+		language "C++"
+		targetdir "build/%{cfg.buildcfg}"
+
+		includedirs { "math/" }
+
+		files { "math/*.hpp", "math/*.cpp" }
+
+		filter "configurations:debug"
+			defines { "DEBUG" }
+			flags { "Symbols" }
+
+		filter "configurations:release"
+			defines { "NDEBUG" }
+			optimize "On"
+
 	project "math-test"
 		kind "ConsoleApp"
 		language "C++"
@@ -15,6 +34,10 @@ solution "math"
 
 		files { "*.hpp", "*.cpp" }
 
+		-- opt in to the precompiled instantiations.
+		defines { "MATH_EXTERN_TEMPLATES" }
+		links { "math" }
+
 		filter "configurations:debug"
 			defines { "DEBUG" }
 			flags { "Symbols" }